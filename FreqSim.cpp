@@ -0,0 +1,175 @@
+/**************************************************************************************************************
+Purpose: This is the implementation file for the frequency based page replacement simulators: LFU, LFU with
+	aging, and LRFU.
+
+Assumptions: This class depends on:
+			FreqSim.h
+*************************************************************************************************************/
+
+#include <math.h>
+#include "FreqSim.h"
+
+/*************************** LFU ***************************/
+
+LFUSimulator::LFUSimulator(int page_size, int max_virtual_mem, int free_frames, int decay_period)
+	: PageSimulator(page_size, max_virtual_mem, free_frames)
+{
+	this->decay_period = decay_period;
+	page_bucket.resize(page_table.getPageTableSize());
+	page_position.resize(page_table.getPageTableSize());
+	next_decay = decay_period;
+}
+
+//Moves the referenced page to the front of the bucket for its new count
+void LFUSimulator::pageHit(int page_num)
+{
+	BucketIterator bucket = page_bucket[page_num];
+	BucketIterator next = bucket;
+	++next;
+	uint64_t frequency = bucket->frequency + 1;
+
+	//use the next bucket if it holds the new count, otherwise create one between the two
+	if (next == buckets.end() || next->frequency != frequency)
+	{
+		FrequencyBucket newBucket;
+		newBucket.frequency = frequency;
+		next = buckets.insert(next, newBucket);
+	}
+	next->pages.splice(next->pages.begin(), bucket->pages, page_position[page_num]);
+	page_bucket[page_num] = next;
+	if (bucket->pages.empty())
+		buckets.erase(bucket);
+
+	if (decay_period > 0 && current_time >= next_decay)
+		decay();
+}
+
+//Puts the newly loaded page in the bucket for a count of 1
+void LFUSimulator::pageLoaded(int page_num)
+{
+	if (buckets.empty() || buckets.front().frequency != 1)
+	{
+		FrequencyBucket newBucket;
+		newBucket.frequency = 1;
+		buckets.push_front(newBucket);
+	}
+	buckets.front().pages.push_front(page_num);
+	page_bucket[page_num] = buckets.begin();
+	page_position[page_num] = buckets.front().pages.begin();
+
+	if (decay_period > 0 && current_time >= next_decay)
+		decay();
+}
+
+//Returns the least recently referenced page of the lowest count
+int LFUSimulator::selectVictim()
+{
+	BucketIterator bucket = buckets.begin();
+	int evictedPageNum = bucket->pages.back();
+	bucket->pages.pop_back();
+	if (bucket->pages.empty())
+		buckets.erase(bucket);
+	return evictedPageNum;
+}
+
+//Halves every count (to no less than 1). Buckets stay in increasing order, so each one is either merged into
+//	the previous one or kept. Within a merged bucket the pages with the higher old count are put in front
+void LFUSimulator::decay()
+{
+	BucketIterator bucket = buckets.begin();
+	while (bucket != buckets.end())
+	{
+		uint64_t frequency = bucket->frequency / 2;
+		if (frequency < 1)
+			frequency = 1;
+
+		if (bucket != buckets.begin())
+		{
+			BucketIterator previous = bucket;
+			--previous;
+			if (previous->frequency == frequency)
+			{
+				for (std::list<int>::iterator it = bucket->pages.begin(); it != bucket->pages.end(); ++it)
+					page_bucket[*it] = previous;
+				previous->pages.splice(previous->pages.begin(), bucket->pages);
+				bucket = buckets.erase(bucket);
+				continue;
+			}
+		}
+		bucket->frequency = frequency;
+		++bucket;
+	}
+	next_decay = current_time + decay_period;
+}
+
+void LFUSimulator::resetPolicy()
+{
+	buckets.clear();
+	page_bucket.assign(page_table.getPageTableSize(), BucketIterator());
+	page_position.assign(page_table.getPageTableSize(), std::list<int>::iterator());
+	next_decay = current_time + decay_period;
+}
+
+/*************************** LRFU ***************************/
+
+LRFUSimulator::LRFUSimulator(int page_size, int max_virtual_mem, int free_frames, double lambda)
+	: PageSimulator(page_size, max_virtual_mem, free_frames)
+{
+	this->lambda = lambda;
+	key_base = 0;
+	page_crf.resize(page_table.getPageTableSize());
+	page_last_time.resize(page_table.getPageTableSize());
+	page_key.resize(page_table.getPageTableSize());
+}
+
+//CRF = 1 + CRF at last reference decayed by the time since then
+void LRFUSimulator::pageHit(int page_num)
+{
+	double age = (double)(current_time - page_last_time[page_num]);
+	CRF_order.erase(std::make_pair(page_key[page_num], page_num));
+	setCRF(page_num, 1.0 + page_crf[page_num] * pow(0.5, lambda * age));
+}
+
+//A newly loaded page has been referenced once
+void LRFUSimulator::pageLoaded(int page_num)
+{
+	setCRF(page_num, 1.0);
+}
+
+//Returns the page with the smallest CRF
+int LRFUSimulator::selectVictim()
+{
+	int evictedPageNum = CRF_order.begin()->second;
+	CRF_order.erase(CRF_order.begin());
+	return evictedPageNum;
+}
+
+//Sets the CRF of page_num at the current time and inserts it in the ordered set
+void LRFUSimulator::setCRF(int page_num, double crf)
+{
+	if (lambda * (current_time - key_base) > LRFU_KEY_REBASE)
+		rebaseKeys();
+	page_crf[page_num] = crf;
+	page_last_time[page_num] = current_time;
+	page_key[page_num] = log2(crf) + lambda * (current_time - key_base);
+	CRF_order.insert(std::make_pair(page_key[page_num], page_num));
+}
+
+void LRFUSimulator::rebaseKeys()
+{
+	double shift = lambda * (current_time - key_base);
+	std::set<std::pair<double, int> > rebased;
+	for (std::set<std::pair<double, int> >::iterator it = CRF_order.begin(); it != CRF_order.end(); ++it)
+	{
+		page_key[it->second] = it->first - shift;
+		rebased.insert(rebased.end(), std::make_pair(page_key[it->second], it->second));
+	}
+	CRF_order.swap(rebased);
+	key_base = current_time;
+}
+
+void LRFUSimulator::resetPolicy()
+{
+	CRF_order.clear();
+	key_base = current_time;
+}
@@ -0,0 +1,98 @@
+/**************************************************************************************************************
+Purpose: This is the header file for the frequency based page replacement simulators: LFU, LFU with aging, and
+	LRFU. They plug into the PageSimulator accounting like FIFO, LRU and Random, and find their victim without
+	scanning the resident pages.
+
+Assumptions: Frequencies only count references made while the page is resident, a page starts again at a count
+	of 1 when it is brought back in. This class depends on:
+			PageSim.h
+*************************************************************************************************************/
+
+#ifndef _FREQ_SIM
+#define _FREQ_SIM
+
+#include <stdint.h>
+#include <list>
+#include <set>
+#include <utility>
+#include <vector>
+#include "PageSim.h"
+
+#define DEFAULT_LFU_DECAY_FACTOR 8 //LFU with aging usually halves its counts every (frames * this) references
+#define DEFAULT_LRFU_LAMBDA 0.001 //LRFU weight of recency, 0 behaves like LFU and 1 like LRU
+#define LRFU_KEY_REBASE 1048576.0 //LRFU keys are moved back to the current time once their time term passes this
+
+//Least frequently used, with the O(1) frequency bucket structure: a list of buckets in increasing frequency,
+//	each holding the pages with that reference count from MRU (front) to LRU (back). The victim is the LRU page
+//	of the first bucket. With a decay period every count is halved once per decay_period references, so pages
+//	that were hot long ago age out
+class LFUSimulator : public PageSimulator
+{
+public:
+	//@param decay_period - references between halvings of every count, 0 disables aging
+	LFUSimulator(int page_size, int max_virtual_mem, int free_frames, int decay_period = 0);
+	const char* getName() const { return decay_period > 0 ? "LFU-Aging" : "LFU"; }
+	//Repeated references raise the count, so runs of a reduced trace have to be replayed
+	bool isReductionExact() const { return false; }
+
+protected:
+	void pageHit(int page_num);
+	void pageLoaded(int page_num);
+	int selectVictim();
+	void resetPolicy();
+
+private:
+	//All resident pages with the same reference count
+	struct FrequencyBucket
+	{
+		uint64_t frequency;
+		std::list<int> pages; //front is the most recently referenced page of this bucket
+	};
+	typedef std::list<FrequencyBucket>::iterator BucketIterator;
+
+	//Halves every count, merging buckets that end up with the same count
+	void decay();
+
+	std::list<FrequencyBucket> buckets; //buckets in increasing frequency, empty buckets are removed
+	std::vector<BucketIterator> page_bucket; //bucket of each resident page, indexed by page number
+	std::vector<std::list<int>::iterator> page_position; //position of each resident page in its bucket
+	int decay_period; //references between halvings, 0 for plain LFU
+	uint64_t next_decay; //value of current_time at which the next halving is done
+};
+
+//Least recently/frequently used. Each page has a combined recency and frequency value
+//	CRF = sum over its references of (1/2)^(lambda * age of the reference), and the page with the smallest
+//	CRF is evicted. Since every CRF decays at the same rate, pages are ordered by
+//	log2(CRF at last reference) + lambda * time of last reference, which only changes when the page is
+//	referenced, so the pages are kept in an ordered set and the victim is its first element. The time term is
+//	measured from key_base, which is moved forward now and then so the keys keep their precision in long runs
+class LRFUSimulator : public PageSimulator
+{
+public:
+	//@param lambda - weight of recency, between 0 (LFU) and 1 (LRU)
+	LRFUSimulator(int page_size, int max_virtual_mem, int free_frames, double lambda = DEFAULT_LRFU_LAMBDA);
+	const char* getName() const { return "LRFU"; }
+	//Repeated references raise the CRF, so runs of a reduced trace have to be replayed
+	bool isReductionExact() const { return false; }
+
+protected:
+	void pageHit(int page_num);
+	void pageLoaded(int page_num);
+	int selectVictim();
+	void resetPolicy();
+
+private:
+	//Sets the CRF of page_num to crf at the current time and reinserts it in the ordered set
+	void setCRF(int page_num, double crf);
+	//Moves key_base to the current time, shifting every key by the same amount so the order is unchanged
+	void rebaseKeys();
+
+	double lambda; //weight of recency
+	std::set<std::pair<double, int> > CRF_order; //(ordering key, page number) of each resident page
+	std::vector<double> page_crf; //CRF of each resident page at its last reference
+	std::vector<uint64_t> page_last_time; //time of the last reference of each resident page
+	std::vector<double> page_key; //ordering key of each resident page in CRF_order
+	uint64_t key_base; //time the key time terms are measured from
+};
+
+#endif
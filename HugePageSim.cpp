@@ -0,0 +1,306 @@
+/**************************************************************************************************************
+Purpose: This is the implementation file for the mixed page size simulator. Base pages live in a regular
+	PageTable with one frame each. A huge page is the whole region of base page entries in that PageTable plus
+	a flag in region_huge, so frames stay accounted in base page units.
+
+Assumptions: Both page sizes are powers of 2 and the huge page size is a multiple of the base page size. This
+	class depends on:
+			HugePageSim.h
+*************************************************************************************************************/
+
+#include "HugePageSim.h"
+
+//Returns the number of set bits in x
+static int countBits(uint64_t x)
+{
+	int count = 0;
+	while (x)
+	{
+		x &= x - 1;
+		count++;
+	}
+	return count;
+}
+
+//Setting constructor, all frames are free and every region is unmapped at start
+HugePageSimulator::HugePageSimulator(int base_page_size, int huge_page_size, int max_virtual_mem, int free_frames,
+	int promote_threshold, int demote_threshold, int base_tlb_entries, int huge_tlb_entries)
+	: page_table(base_page_size, max_virtual_mem, free_frames)
+{
+	this->base_page_size = base_page_size;
+	this->huge_page_size = huge_page_size;
+	this->max_virtual_mem = max_virtual_mem;
+	number_of_frames = free_frames;
+	this->promote_threshold = promote_threshold;
+	this->demote_threshold = demote_threshold;
+	this->base_tlb_entries = base_tlb_entries;
+	this->huge_tlb_entries = huge_tlb_entries;
+
+	base_shift = log2Int(base_page_size);
+	//at most 64 lines per base page so a page's referenced lines fit in one mask, never finer than 64 B
+	line_shift = base_shift - 6 > 6 ? base_shift - 6 : 6;
+	if (line_shift > base_shift)
+		line_shift = base_shift;
+	pages_per_huge = huge_page_size / base_page_size;
+	region_shift = log2Int(pages_per_huge);
+	number_of_regions = (page_table.getPageTableSize() + pages_per_huge - 1) / pages_per_huge;
+
+	reset();
+}
+
+//Clears the page table, the statistics and the LRU state
+void HugePageSimulator::reset()
+{
+	page_table.reset(base_page_size, max_virtual_mem, number_of_frames);
+	current_time = 0;
+	stats = HugePageStats();
+	touched_lines_base = 0;
+	touched_lines_huge = 0;
+
+	int page_count = page_table.getPageTableSize();
+	region_huge.assign(number_of_regions, false);
+	region_resident.assign(number_of_regions, 0);
+	line_mask.assign(page_count, 0);
+	LRU_list.clear();
+	LRU_position.assign(page_count + number_of_regions, std::list<int>::iterator());
+	in_LRU.assign(page_count + number_of_regions, false);
+}
+
+//Simulates a batch of n references and returns the running statistics
+HugePageStats HugePageSimulator::access(const uint64_t* addrs, const uint8_t* is_write, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		//skip references outside of virtual memory
+		if (addrs[i] >= (uint64_t)max_virtual_mem)
+		{
+			stats.total.invalid_references++;
+			continue;
+		}
+		reference(addrs[i], is_write != NULL && is_write[i] != 0);
+	}
+	return getStats();
+}
+
+//Returns the running statistics with the resident page, TLB reach and fragmentation fields filled in
+HugePageStats HugePageSimulator::getStats() const
+{
+	HugePageStats s = stats;
+	uint64_t line_size = (uint64_t)1 << line_shift;
+	uint64_t huge_count = 0;
+	for (int r = 0; r < number_of_regions; r++)
+		if (region_huge[r])
+			huge_count++;
+	uint64_t base_count = page_table.getPageTableCount() - huge_count * pages_per_huge;
+
+	s.base.resident_pages = base_count;
+	s.huge.resident_pages = huge_count;
+	s.base.tlb_reach = (base_count < (uint64_t)base_tlb_entries ? base_count : base_tlb_entries) * (uint64_t)base_page_size;
+	s.huge.tlb_reach = (huge_count < (uint64_t)huge_tlb_entries ? huge_count : huge_tlb_entries) * (uint64_t)huge_page_size;
+	s.base.internal_fragmentation = base_count * base_page_size - touched_lines_base * line_size;
+	s.huge.internal_fragmentation = huge_count * huge_page_size - touched_lines_huge * line_size;
+	return s;
+}
+
+//Simulates one reference to a valid address
+void HugePageSimulator::reference(uint64_t addr, bool write)
+{
+	int p = (int)(addr >> base_shift);
+	int r = p >> region_shift;
+	current_time++;
+	stats.total.memory_references++;
+
+	if (region_huge[r]) //hit in a huge page
+	{
+		touchMapping(page_table.getPageTableSize() + r);
+	}
+	else if (page_table.checkPageinTable(p)) //hit in a base page
+	{
+		touchMapping(p);
+	}
+	else if (region_resident[r] + 1 >= promote_threshold && pages_per_huge <= number_of_frames)
+	{
+		//dense region, fault the whole huge page in
+		if (region_resident[r] > 0)
+			stats.promotions++;
+		promote(r);
+		stats.huge.faults++;
+		stats.total.page_faults++;
+	}
+	else if (number_of_frames <= 0) //no physical memory to bring the page into
+	{
+		stats.base.faults++;
+		stats.total.page_faults++;
+		return;
+	}
+	else //base page fault
+	{
+		makeRoom(1);
+		page_table.addPagetoTable(p, current_time, page_table.giveFreeFrame());
+		region_resident[r]++;
+		touchMapping(p);
+		stats.base.faults++;
+		stats.total.page_faults++;
+	}
+
+	touchLine(p, addr);
+	page_table[p]->last_page_access_time = current_time;
+	//if a write then the referenced page is marked dirty
+	if (write)
+		page_table[p]->dirty = true;
+}
+
+//Maps region r as a huge page, every base page of the region becomes resident
+void HugePageSimulator::promote(int r)
+{
+	//evicting may take base pages of this region too, so the need is recomputed on every eviction
+	while (page_table.getNumberofFreeFrames() < pages_per_huge - region_resident[r])
+		evictVictim();
+
+	int first = r << region_shift;
+	int last = first + pages_per_huge;
+	if (last > page_table.getPageTableSize())
+		last = page_table.getPageTableSize();
+	for (int p = first; p < last; p++)
+	{
+		if (page_table.checkPageinTable(p))
+		{
+			//existing base mapping is absorbed into the huge page
+			forgetMapping(p);
+			int lines = linesTouched(p);
+			touched_lines_base -= lines;
+			touched_lines_huge += lines;
+		}
+		else page_table.addPagetoTable(p, current_time, page_table.giveFreeFrame());
+	}
+	region_resident[r] = 0;
+	region_huge[r] = true;
+	touchMapping(page_table.getPageTableSize() + r);
+}
+
+//Evicts (or demotes) the LRU mapping until at least n frames are free
+void HugePageSimulator::makeRoom(int n)
+{
+	while (page_table.getNumberofFreeFrames() < n)
+		evictVictim();
+}
+
+//Evicts the LRU mapping. A sparsely referenced huge page is demoted, its unreferenced base pages are freed and
+//	the referenced ones stay resident as base pages at the LRU end of the list
+void HugePageSimulator::evictVictim()
+{
+	int key = LRU_list.back();
+	int page_count = page_table.getPageTableSize();
+
+	if (key < page_count) //base page victim
+	{
+		int p = key;
+		forgetMapping(p);
+		if (page_table[p]->dirty) //check if this is a flush
+		{
+			stats.base.flushes++;
+			stats.total.flushes++;
+		}
+		touched_lines_base -= linesTouched(p);
+		line_mask[p] = 0;
+		page_table.removePagefromTable(p);
+		region_resident[p >> region_shift]--;
+		stats.base.evictions++;
+		stats.total.page_replacements++;
+		return;
+	}
+
+	int r = key - page_count;
+	int first = r << region_shift;
+	int last = first + pages_per_huge;
+	if (last > page_count)
+		last = page_count;
+	int touched_pages = 0;
+	bool dirty = false;
+	for (int p = first; p < last; p++)
+	{
+		if (line_mask[p] != 0)
+			touched_pages++;
+		if (page_table[p]->dirty)
+			dirty = true;
+	}
+
+	forgetMapping(key);
+	region_huge[r] = false;
+	if (touched_pages < demote_threshold)
+	{
+		//demote: keep the referenced base pages, free the rest
+		for (int p = first; p < last; p++)
+		{
+			if (line_mask[p] != 0)
+			{
+				int lines = linesTouched(p);
+				touched_lines_huge -= lines;
+				touched_lines_base += lines;
+				LRU_list.push_back(p);
+				LRU_position[p] = --LRU_list.end();
+				in_LRU[p] = true;
+				region_resident[r]++;
+			}
+			else page_table.removePagefromTable(p);
+		}
+		stats.demotions++;
+		return;
+	}
+
+	//evict the whole huge page
+	if (dirty) //check if this is a flush
+	{
+		stats.huge.flushes++;
+		stats.total.flushes++;
+	}
+	for (int p = first; p < last; p++)
+	{
+		touched_lines_huge -= linesTouched(p);
+		line_mask[p] = 0;
+		page_table.removePagefromTable(p);
+	}
+	stats.huge.evictions++;
+	stats.total.page_replacements++;
+}
+
+//Marks the line containing addr in base page p as referenced
+void HugePageSimulator::touchLine(int p, uint64_t addr)
+{
+	uint64_t bit = (uint64_t)1 << ((addr >> line_shift) & ((1 << (base_shift - line_shift)) - 1));
+	if (line_mask[p] & bit)
+		return;
+	line_mask[p] |= bit;
+	if (region_huge[p >> region_shift])
+		touched_lines_huge++;
+	else touched_lines_base++;
+}
+
+//Moves the given mapping key to the front of the LRU list, inserting it if it is not in the list
+void HugePageSimulator::touchMapping(int key)
+{
+	if (in_LRU[key])
+		LRU_list.splice(LRU_list.begin(), LRU_list, LRU_position[key]);
+	else
+	{
+		LRU_list.push_front(key);
+		LRU_position[key] = LRU_list.begin();
+		in_LRU[key] = true;
+	}
+}
+
+//Removes the given mapping key from the LRU list
+void HugePageSimulator::forgetMapping(int key)
+{
+	if (in_LRU[key])
+	{
+		LRU_list.erase(LRU_position[key]);
+		in_LRU[key] = false;
+	}
+}
+
+//Returns the number of referenced lines in base page p
+int HugePageSimulator::linesTouched(int p) const
+{
+	return countBits(line_mask[p]);
+}
@@ -0,0 +1,123 @@
+/**************************************************************************************************************
+Purpose: This is the header file for the mixed page size simulator. It simulates base pages (e.g. 4 KB) alongside
+	huge pages (e.g. 2 MB) the way transparent huge pages work: a huge page aligned region whose resident base
+	page count reaches the promotion threshold is mapped as one huge page, and a huge page that is chosen for
+	eviction while most of it was never referenced is demoted back to base pages instead of being evicted
+	whole. Physical memory is accounted in base page frames, a huge page uses (huge size / base size) frames.
+	Replacement is LRU over mappings (base pages and huge pages).
+
+Assumptions: Both page sizes are powers of 2 and the huge page size is a multiple of the base page size. This
+	class does no I/O. This class depends on:
+			PageSim.h
+			PageTable.h
+*************************************************************************************************************/
+
+#ifndef _HUGE_PAGE_SIM
+#define _HUGE_PAGE_SIM
+
+#include <stddef.h>
+#include <stdint.h>
+#include <list>
+#include <vector>
+#include "PageSim.h"
+#include "PageTable.h"
+
+#define DEFAULT_BASE_PAGE_SIZE 4096 //4 KB base pages
+#define DEFAULT_HUGE_PAGE_SIZE 2097152 //2 MB huge pages
+#define DEFAULT_BASE_TLB_ENTRIES 64 //TLB entries for base pages
+#define DEFAULT_HUGE_TLB_ENTRIES 32 //TLB entries for huge pages
+
+//Statistics for one of the two page sizes
+struct PageSizeStats
+{
+	uint64_t faults; //page faults that were satisfied by mapping a page of this size
+	uint64_t evictions; //pages of this size evicted from main memory
+	uint64_t flushes; //evicted pages of this size that were dirty
+	uint64_t resident_pages; //pages of this size currently in main memory
+	uint64_t tlb_reach; //bytes covered by the TLB entries for this size, min(entries, resident pages) * page size
+	uint64_t internal_fragmentation; //bytes of resident pages of this size that were never referenced
+};
+
+//Statistics gathered by the mixed page size simulator
+struct HugePageStats
+{
+	SimStats total; //totals over both page sizes, page_replacements counts every eviction
+	PageSizeStats base; //base page statistics
+	PageSizeStats huge; //huge page statistics
+	uint64_t promotions; //regions with resident base pages that were promoted to a huge page
+	uint64_t demotions; //huge pages split back into base pages because of internal fragmentation
+};
+
+//This class simulates a demand paged system with two page sizes
+class HugePageSimulator
+{
+public:
+	//Setting constructor:
+	//@param base_page_size - the base page size in Bytes
+	//@param huge_page_size - the huge page size in Bytes
+	//@param max_virtual_mem - the maximum virtual memory of the simulated process in Bytes
+	//@param free_frames - the number of base page frames in the simulated physical memory
+	//@param promote_threshold - a region is mapped as a huge page when a fault would bring its resident base
+	//	page count to this value. 1 maps every region as a huge page on first touch, a value larger than the
+	//	number of base pages in a huge page disables huge pages
+	//@param demote_threshold - a huge page chosen for eviction with fewer than this many referenced base pages
+	//	is demoted instead, keeping only its referenced base pages. 0 disables demotion
+	HugePageSimulator(int base_page_size, int huge_page_size, int max_virtual_mem, int free_frames,
+		int promote_threshold, int demote_threshold,
+		int base_tlb_entries = DEFAULT_BASE_TLB_ENTRIES, int huge_tlb_entries = DEFAULT_HUGE_TLB_ENTRIES);
+
+	//Simulates n references, is_write may be NULL (every reference is a read). Returns the running statistics
+	HugePageStats access(const uint64_t* addrs, const uint8_t* is_write, size_t n);
+
+	//Clears the page table, the statistics and the LRU state
+	void reset();
+
+	//Returns the statistics gathered since construction or the last reset()
+	HugePageStats getStats() const;
+
+	int getPagesPerHugePage() const { return pages_per_huge; }
+
+private:
+	//Simulates one reference to a valid address
+	void reference(uint64_t addr, bool write);
+	//Maps region r as a huge page, bringing in every base page of it that is not resident
+	void promote(int r);
+	//Evicts (or demotes) the LRU mapping until at least n frames are free
+	void makeRoom(int n);
+	//Evicts or demotes the LRU mapping
+	void evictVictim();
+	//Marks the line containing addr in base page p as referenced
+	void touchLine(int p, uint64_t addr);
+	//Moves the given mapping key to the front of the LRU list, inserting it if it is not in the list
+	void touchMapping(int key);
+	//Removes the given mapping key from the LRU list
+	void forgetMapping(int key);
+	//Returns the number of referenced lines in base page p
+	int linesTouched(int p) const;
+
+	PageTable page_table; //base page table, a huge page occupies every entry of its region
+	int base_page_size, huge_page_size, max_virtual_mem, number_of_frames;
+	int base_shift; //log2(base_page_size)
+	int line_shift; //log2 of the referenced-line granularity used for internal fragmentation
+	int pages_per_huge; //base pages per huge page
+	int region_shift; //log2(pages_per_huge)
+	int number_of_regions; //huge page sized regions of virtual memory
+	int promote_threshold, demote_threshold;
+	int base_tlb_entries, huge_tlb_entries;
+	uint64_t current_time; //logical clock, advanced once per valid reference
+
+	std::vector<bool> region_huge; //true if the region is mapped as a huge page
+	std::vector<int> region_resident; //resident base pages of each region mapped as base pages
+	std::vector<uint64_t> line_mask; //referenced lines of each resident base page, one bit per line
+
+	//LRU list of mappings, front is MRU. Key p < page table size is base page p, page table size + r is huge region r
+	std::list<int> LRU_list;
+	std::vector<std::list<int>::iterator> LRU_position; //position of each mapping key in LRU_list
+	std::vector<bool> in_LRU; //true if the mapping key is in LRU_list
+
+	HugePageStats stats; //running counters, the derived fields are filled in by getStats()
+	uint64_t touched_lines_base; //referenced lines in resident base pages
+	uint64_t touched_lines_huge; //referenced lines in resident huge pages
+};
+
+#endif
@@ -0,0 +1,274 @@
+/**************************************************************************************************************
+Purpose: This is the implementation file for the page replacement simulators. The reference loop and the
+	fault, replacement and flush accounting are shared by every algorithm in PageSimulator::accessPage, the
+	derived classes only keep the state needed to pick a victim page.
+
+Assumptions: Addresses are byte addresses in the simulated virtual address space. This class depends on:
+			PageSim.h
+*************************************************************************************************************/
+
+#include "PageSim.h"
+#include "FreqSim.h"
+
+int log2Int(int n)
+{
+	int shift = 0;
+	while ((1 << shift) < n)
+		shift++;
+	return shift;
+}
+
+PageNumberMap::PageNumberMap(int page_size, int max_virtual_mem)
+{
+	this->page_size = page_size;
+	this->max_virtual_mem = max_virtual_mem;
+	shift = page_size > 0 && (1 << log2Int(page_size)) == page_size ? log2Int(page_size) : -1;
+}
+
+//Setting constructor, all frames are free and all statistics are zero at start
+PageSimulator::PageSimulator(int page_size, int max_virtual_mem, int free_frames)
+	: page_table(page_size, max_virtual_mem, free_frames), page_map(page_size, max_virtual_mem)
+{
+	this->page_size = page_size;
+	this->max_virtual_mem = max_virtual_mem;
+	number_of_frames = free_frames;
+	current_time = 0;
+	last_victim = -1;
+	stats = SimStats();
+}
+
+//Destructor
+PageSimulator::~PageSimulator()
+{
+	//Nothing to do, the page table cleans up its own entries
+}
+
+//Clears the page table, the statistics and the replacement algorithm state
+void PageSimulator::reset(uint64_t start_time)
+{
+	page_table.reset(page_size, max_virtual_mem, number_of_frames);
+	stats = SimStats();
+	current_time = start_time;
+	last_victim = -1;
+	resetPolicy();
+}
+
+//Simulates a batch of n references and returns the running statistics
+SimStats PageSimulator::access(const uint64_t* addrs, const uint8_t* is_write, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		//get page number from virtual reference address (not computing offset since not required for simulation),
+		//	skipping references outside of virtual memory
+		int page_num_referenced = page_map.pageOf(addrs[i]);
+		if (page_num_referenced < 0)
+		{
+			stats.invalid_references++;
+			continue;
+		}
+
+		accessPage(page_num_referenced, is_write != NULL && is_write[i] != 0);
+	}
+	return stats;
+}
+
+//Simulates a batch of n reduced records and returns the running statistics
+SimStats PageSimulator::accessReduced(const ReducedRef* refs, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		//a run of no references has nothing to simulate, and would wrap the count of its repeated references
+		if (refs[i].count == 0)
+			continue;
+		if (refs[i].page_num == REDUCED_INVALID_PAGE || refs[i].page_num >= (uint32_t)page_table.getPageTableSize())
+		{
+			stats.invalid_references += refs[i].count;
+			continue;
+		}
+
+		//the first reference of the run is the only one that can fault, the page stays resident for the rest
+		accessPage((int)refs[i].page_num, refs[i].dirty);
+		if (isReductionExact() && number_of_frames > 0)
+		{
+			current_time += refs[i].count - 1;
+			stats.memory_references += refs[i].count - 1;
+		}
+		else
+		{
+			for (uint32_t j = 1; j < refs[i].count; j++)
+				accessPage((int)refs[i].page_num, false);
+		}
+	}
+	return stats;
+}
+
+//Simulates a single reference to page_num
+void PageSimulator::accessPage(int page_num, bool write)
+{
+	current_time++;
+	stats.memory_references++;
+	last_victim = -1;
+
+	//Check if referenced page is in the page table
+	if (page_table.checkPageinTable(page_num))
+	{
+		page_table[page_num]->last_page_access_time = current_time;
+		pageHit(page_num);
+	}
+	else if (number_of_frames <= 0) //no physical memory to bring the page into
+	{
+		stats.page_faults++;
+		return;
+	}
+	else //page fault, bring the page into main memory
+	{
+		//check if no free frames, if so evict a page chosen by the replacement algorithm
+		if (page_table.mainMemisFull())
+		{
+			int pageNumtoRemove = selectVictim();
+
+			if (page_table[pageNumtoRemove]->dirty) //check if this is a flush
+				stats.flushes++;
+
+			page_table.replace(pageNumtoRemove, page_num, current_time);
+			stats.page_replacements++;
+			last_victim = pageNumtoRemove;
+		}
+		else //main memory is not full, add to table normally
+		{
+			page_table.addPagetoTable(page_num, current_time, page_table.giveFreeFrame());
+		}
+		pageLoaded(page_num);
+		stats.page_faults++;
+	}
+
+	//if a write then the referenced page is marked dirty
+	if (write)
+		page_table[page_num]->dirty = true;
+}
+
+//Default hit handling - nothing to do for algorithms that do not track references
+void PageSimulator::pageHit(int page_num)
+{
+}
+
+/*************************** FIFO ***************************/
+
+FIFOSimulator::FIFOSimulator(int page_size, int max_virtual_mem, int free_frames)
+	: PageSimulator(page_size, max_virtual_mem, free_frames)
+{
+}
+
+//Queues the newly loaded page behind every other resident page
+void FIFOSimulator::pageLoaded(int page_num)
+{
+	FIFO_queue.push(page_num);
+}
+
+//Returns the page at the front of the FIFO queue
+int FIFOSimulator::selectVictim()
+{
+	int evictedPageNum = FIFO_queue.front();
+	FIFO_queue.pop();
+	return evictedPageNum;
+}
+
+void FIFOSimulator::resetPolicy()
+{
+	while (!FIFO_queue.empty())
+		FIFO_queue.pop();
+}
+
+/*************************** LRU ***************************/
+
+LRUSimulator::LRUSimulator(int page_size, int max_virtual_mem, int free_frames)
+	: PageSimulator(page_size, max_virtual_mem, free_frames)
+{
+	LRU_position.resize(page_table.getPageTableSize());
+}
+
+//Moves the referenced page to the front of the LRU list
+void LRUSimulator::pageHit(int page_num)
+{
+	LRU_list.splice(LRU_list.begin(), LRU_list, LRU_position[page_num]);
+}
+
+//Inserts the newly loaded page as the MRU page
+void LRUSimulator::pageLoaded(int page_num)
+{
+	LRU_list.push_front(page_num);
+	LRU_position[page_num] = LRU_list.begin();
+}
+
+//Returns the page at the back of the LRU list
+int LRUSimulator::selectVictim()
+{
+	int evictedPageNum = LRU_list.back();
+	LRU_list.pop_back();
+	return evictedPageNum;
+}
+
+void LRUSimulator::resetPolicy()
+{
+	LRU_list.clear();
+	LRU_position.assign(page_table.getPageTableSize(), std::list<int>::iterator());
+}
+
+/*************************** Random ***************************/
+
+RandomSimulator::RandomSimulator(int page_size, int max_virtual_mem, int free_frames, uint64_t seed)
+	: PageSimulator(page_size, max_virtual_mem, free_frames)
+{
+	this->seed = seed;
+	rng_state = seed ? seed : 1; //xorshift state must never be 0
+}
+
+//Returns a random integer in [0, n) using xorshift64*
+int RandomSimulator::ranInt(int n)
+{
+	rng_state ^= rng_state >> 12;
+	rng_state ^= rng_state << 25;
+	rng_state ^= rng_state >> 27;
+	return (int)(((rng_state * 2685821657736338717ULL) >> 32) % (uint64_t)n);
+}
+
+void RandomSimulator::pageLoaded(int page_num)
+{
+	random_list.push_back(page_num);
+}
+
+//Picks a random resident page, the last page in the list is moved into its slot so removal is O(1)
+int RandomSimulator::selectVictim()
+{
+	int randIndex = ranInt(random_list.size());
+	int randomPage = random_list[randIndex];
+	random_list[randIndex] = random_list.back();
+	random_list.pop_back();
+	return randomPage;
+}
+
+void RandomSimulator::resetPolicy()
+{
+	random_list.clear();
+	rng_state = seed ? seed : 1;
+}
+
+/*************************** Factory ***************************/
+
+//Creates a simulator for the named replacement algorithm, NULL if the name is not known
+PageSimulator* createSimulator(const std::string& policy, int page_size, int max_virtual_mem, int free_frames)
+{
+	if (policy == "FIFO")
+		return new FIFOSimulator(page_size, max_virtual_mem, free_frames);
+	else if (policy == "LRU")
+		return new LRUSimulator(page_size, max_virtual_mem, free_frames);
+	else if (policy == "Random")
+		return new RandomSimulator(page_size, max_virtual_mem, free_frames);
+	else if (policy == "LFU")
+		return new LFUSimulator(page_size, max_virtual_mem, free_frames);
+	else if (policy == "LFU-Aging")
+		return new LFUSimulator(page_size, max_virtual_mem, free_frames, free_frames * DEFAULT_LFU_DECAY_FACTOR);
+	else if (policy == "LRFU")
+		return new LRFUSimulator(page_size, max_virtual_mem, free_frames);
+	else return NULL;
+}
@@ -0,0 +1,206 @@
+/**************************************************************************************************************
+Purpose: This is the header file for the page replacement simulators. Each simulator owns its own PageTable,
+	statistics, and victim selection state, so several simulators can be run in one process (and on separate
+	threads) without sharing anything. References are fed to a simulator in batches through access(), which
+	returns the running statistics for that simulator.
+
+Assumptions: Addresses are byte addresses in the simulated virtual address space. Addresses at or beyond the
+	virtual memory size are skipped and counted as invalid references. This library does not do any I/O.
+	This class depends on:
+			PageTable.h
+			page.h
+*************************************************************************************************************/
+
+#ifndef _PAGE_SIM
+#define _PAGE_SIM
+
+#include <stddef.h>
+#include <stdint.h>
+#include <list>
+#include <queue>
+#include <string>
+#include <vector>
+#include "PageTable.h"
+
+#define DEFAULT_MAX_VIRTUAL_MEM 134217728 //default virtual memory is 128 MB = 134217728 Bytes (2^27)
+
+//Statistics gathered by a simulator over every reference it has been given since construction or reset()
+struct SimStats
+{
+	uint64_t memory_references; //valid references processed
+	uint64_t page_faults; //references to a page that was not in main memory
+	uint64_t page_replacements; //page faults that required a victim page to be evicted
+	uint64_t flushes; //replacements whose victim page was dirty
+	uint64_t invalid_references; //references outside of virtual memory, these are skipped
+};
+
+#define REDUCED_INVALID_PAGE 0xFFFFFFFF //page number of a ReducedRef that stands for invalid references
+
+//A run of count consecutive references to one page, as produced by the TraceReducer (TraceReduce.h).
+//	dirty is true if any reference in the run was a write
+struct ReducedRef
+{
+	uint32_t page_num; //page number, or REDUCED_INVALID_PAGE for references outside of virtual memory
+	uint32_t count; //number of references in the run, at least 1
+	bool dirty; //true if the run contains a write reference
+};
+
+//Returns log2(n) rounded up, which is log2(n) when n is a power of 2
+int log2Int(int n);
+
+//Maps byte addresses to page numbers for one page size and virtual memory size. Every simulator that takes raw
+//	addresses uses it, so they all agree on which references are invalid
+class PageNumberMap
+{
+public:
+	PageNumberMap(int page_size, int max_virtual_mem);
+
+	//Returns the page number of addr, or -1 if addr is outside virtual memory. The page number is computed
+	//	with a shift when the page size is a power of 2 and with a division otherwise
+	int pageOf(uint64_t addr) const
+	{
+		if (addr >= (uint64_t)max_virtual_mem)
+			return -1;
+		if (shift >= 0)
+			return (int)(addr >> shift);
+		return (int)(addr / page_size);
+	}
+
+private:
+	int page_size;
+	int shift; //log2(page_size) if page_size is a power of 2, otherwise -1
+	int max_virtual_mem;
+};
+
+//Base class for a page replacement simulation. The fault, replacement and flush accounting is done here,
+//	derived classes only decide which resident page to evict
+class PageSimulator
+{
+public:
+	//Setting constructor:
+	//@param page_size - the page size in Bytes
+	//@param max_virtual_mem - the maximum virtual memory of the simulated process in Bytes
+	//@param free_frames - the number of frames in the simulated physical memory
+	PageSimulator(int page_size, int max_virtual_mem, int free_frames);
+	virtual ~PageSimulator();
+	//A simulator owns its page table, so it cannot be copied
+	PageSimulator(const PageSimulator&) = delete;
+	PageSimulator& operator=(const PageSimulator&) = delete;
+
+	//Simulates n references. addrs[i] is the byte address of the i-th reference and is_write[i] is non-zero
+	//	if it is a write reference. is_write may be NULL, in which case every reference is a read.
+	//	Returns the running statistics of this simulator after the batch
+	SimStats access(const uint64_t* addrs, const uint8_t* is_write, size_t n);
+
+	//Simulates a single reference to the given page number, page_num must be within the page table
+	void accessPage(int page_num, bool write);
+
+	//Simulates n reduced records, which must have been reduced with this simulator's page size. For algorithms
+	//	where isReductionExact() is true the statistics are the same as for the original trace, otherwise the
+	//	repeated references of each run are replayed one at a time. Records with a count of 0 are skipped.
+	//	Returns the running statistics
+	SimStats accessReduced(const ReducedRef* refs, size_t n);
+
+	//Returns true if the repeated references in a run can be skipped without changing the results, which holds
+	//	when a hit on the page that was just referenced does not change the replacement state
+	virtual bool isReductionExact() const { return true; }
+
+	//Clears the page table, the statistics and the replacement algorithm state. The logical clock restarts at
+	//	start_time, so a simulator can be started as if it had already been running that many references
+	void reset(uint64_t start_time = 0);
+
+	//Returns the statistics gathered since construction or the last reset()
+	const SimStats& getStats() const { return stats; }
+	//Returns the page evicted by the most recent reference, or -1 if it did not evict a page
+	int getLastVictim() const { return last_victim; }
+	//Returns the short name of the replacement algorithm (e.g. "FIFO")
+	virtual const char* getName() const = 0;
+
+	int getPageSize() const { return page_size; }
+	int getNumberofFrames() const { return number_of_frames; }
+	int getPageTableSize() { return page_table.getPageTableSize(); }
+
+protected:
+	//Called when a referenced page is already in main memory
+	virtual void pageHit(int page_num);
+	//Called after a page has been brought into main memory
+	virtual void pageLoaded(int page_num) = 0;
+	//Returns the resident page to evict. The algorithm must forget the returned page
+	virtual int selectVictim() = 0;
+	//Clears the replacement algorithm state
+	virtual void resetPolicy() = 0;
+
+	PageTable page_table; //page table and free frame list of the simulated process
+	SimStats stats; //running statistics
+	int page_size; //page size in Bytes
+	int max_virtual_mem; //virtual memory size in Bytes
+	PageNumberMap page_map; //maps reference addresses to page numbers
+	int number_of_frames; //number of frames in physical memory
+	uint64_t current_time; //logical clock, advanced once per valid reference
+	int last_victim; //page evicted by the most recent reference, -1 if none
+};
+
+//First in first out: evicts the page that has been in main memory the longest
+class FIFOSimulator : public PageSimulator
+{
+public:
+	FIFOSimulator(int page_size, int max_virtual_mem, int free_frames);
+	const char* getName() const { return "FIFO"; }
+
+protected:
+	void pageLoaded(int page_num);
+	int selectVictim();
+	void resetPolicy();
+
+private:
+	//when pages are added to the page table, their page number is placed in this queue
+	std::queue<int> FIFO_queue;
+};
+
+//Least recently used: evicts the page whose last reference is the oldest
+class LRUSimulator : public PageSimulator
+{
+public:
+	LRUSimulator(int page_size, int max_virtual_mem, int free_frames);
+	const char* getName() const { return "LRU"; }
+
+protected:
+	void pageHit(int page_num);
+	void pageLoaded(int page_num);
+	int selectVictim();
+	void resetPolicy();
+
+private:
+	//The back element of the list holds the LRU page, while the front element holds the MRU page
+	std::list<int> LRU_list;
+	//position of each resident page in LRU_list, indexed by page number, so a hit is moved to the front in O(1)
+	std::vector<std::list<int>::iterator> LRU_position;
+};
+
+//Random: evicts a uniformly chosen resident page. Each simulator has its own generator, seeded by the caller
+class RandomSimulator : public PageSimulator
+{
+public:
+	RandomSimulator(int page_size, int max_virtual_mem, int free_frames, uint64_t seed = 433);
+	const char* getName() const { return "Random"; }
+
+protected:
+	void pageLoaded(int page_num);
+	int selectVictim();
+	void resetPolicy();
+
+private:
+	//Returns a random integer in [0, n)
+	int ranInt(int n);
+
+	//resident page numbers, a random index of this list is picked to determine the page to replace
+	std::vector<int> random_list;
+	uint64_t seed; //seed given at construction, used again on reset
+	uint64_t rng_state; //xorshift64* state
+};
+
+//Creates a simulator for the named replacement algorithm ("FIFO", "LRU", "Random", "LFU", "LFU-Aging" or "LRFU")
+//	with its default settings. Returns NULL if the name is not known, the caller owns the returned simulator
+PageSimulator* createSimulator(const std::string& policy, int page_size, int max_virtual_mem, int free_frames);
+
+#endif
@@ -9,7 +9,6 @@ Purpose: This is the implementation file for the Page Table data structure. This
 Assumptions: It is assumed that this data structure will be used in a in a simulation for paged virtual
 	memory in a computer system. This class also depends on:
 			page.h
-			random.h
 *************************************************************************************************************/
 
 #include "PageTable.h"
@@ -17,7 +16,10 @@ Assumptions: It is assumed that this data structure will be used in a in a simul
 //Default constructor - should not be used
 PageTable::PageTable()
 {
+	page_table_entries = NULL;
+	page_table_size = 0;
 	page_table_count = 0;
+	free_frame_count = 0;
 }
 
 //This constructor takes the virtual memory size and page size (both in Bytes)
@@ -55,37 +57,40 @@ PageTable::~PageTable()
 			page_table_entries[i] = NULL;
 		}
 	}
+	delete[] page_table_entries;
 }
 
-//Resets the state of the page table and internal queues/lists that are used
-//	in the simulations for the different page replacement algorithms
+//Resets the state of the page table and the free frame list, the page table array is only
+//	reallocated if the new parameters change its size
 void PageTable::reset(int page_size, int max_virtual_mem, int free_frames)
 {
-	//set page table size equal to the number of pages that the virtual memory has (based on the page size)
-	page_table_size = max_virtual_mem / page_size;
-	//page_table_entries = new page*[page_table_size]; //initialize the page table array to size large enough to hold all pages
-	page_table_count = 0; //no reference in page table at start
-	free_frame_count = 0;
-
 	for (int i = 0; i < page_table_size; i++)
 	{
 		delete page_table_entries[i];
 		page_table_entries[i] = NULL;
 	}
 
+	//set page table size equal to the number of pages that the virtual memory has (based on the page size)
+	int new_size = max_virtual_mem / page_size;
+	if (new_size != page_table_size)
+	{
+		delete[] page_table_entries;
+		page_table_size = new_size;
+		page_table_entries = new page*[page_table_size];
+		for (int i = 0; i < page_table_size; i++)
+			page_table_entries[i] = NULL;
+	}
+	page_table_count = 0; //no reference in page table at start
+	free_frame_count = 0;
+
 	//add free frame numbers to the free frames queue (all frames are free at start of simulation)
+	while (!free_frame_list.empty())
+		free_frame_list.pop();
 	for (int i = 0; i < free_frames; i++)
 	{
 		free_frame_list.push(i);
 	}
 	free_frame_count = free_frame_list.size();
-
-	while (!FIFO_queue.empty())
-		FIFO_queue.pop();
-	while(!LRU_list.empty())
-		LRU_list.pop_back();
-
-	random_list.clear();
 }
 
 //Overloaded bracket operator for direcly accessing page entry pointers in the page table
@@ -112,45 +117,18 @@ int PageTable::giveFreeFrame()
 }
 
 //Adds the given pageNumber to the page table, updates that pages time, and assigns it to the given free frame
-void PageTable::addPagetoTable(int pageNumber, int currentTime, int freeFrame)
+//	Returns false if no free frame was provided - this should not happen if the caller checks mainMemisFull first
+bool PageTable::addPagetoTable(int pageNumber, uint64_t currentTime, int freeFrame)
 {
-	if (freeFrame != -1)
-	{
-		page* p = new page(pageNumber, freeFrame, currentTime);
-		page_table_entries[pageNumber] = p; //"add" page to table
-		page_table_entries[pageNumber]->valid = true; //reassert that page is valid (should have been set in constructor)
-		page_table_entries[pageNumber]->dirty = false; //reassert that page is NOT dirty yet because it was just added to the table(should have been set in constructor)
-		FIFO_queue.push(pageNumber);
-		//LRU_list.updateLRU(pageNumber);
-		random_list.push_back(pageNumber);
-		page_table_count++;
-	}
-	else
-	{
-		//Debug msg - this should not happen if caller provides a free frame
-		std::cout << "**Debug message: control reached call to addPagetoTable with a full main memory***\n"; 	
-	}
-}
+	if (freeFrame == -1)
+		return false;
 
-//Adds the given pageNumber to the page table for the LRU algorithm, updates that pages time, and assigns it to the given free frame
-void PageTable::addPagetoTableLRU(int pageNumber, int currentTime, int freeFrame)
-{
-	if (freeFrame != -1)
-	{
-		page* p = new page(pageNumber, freeFrame, currentTime);
-		page_table_entries[pageNumber] = p; //"add" page to table
-		page_table_entries[pageNumber]->valid = true; //reassert that page is valid (should have been set in constructor)
-		page_table_entries[pageNumber]->dirty = false; //reassert that page is NOT dirty yet because it was just added to the table(should have been set in constructor)
-		//FIFO_queue.push(pageNumber);
-		updateLRU(pageNumber);
-		//random_list.push_back(pageNumber);
-		page_table_count++;
-	}
-	else
-	{
-		//Debug msg - this should not happen if caller provides a free frame
-		std::cout << "**Debug message: control reached call to addPagetoTable with a full main memory***\n"; 	
-	}
+	page* p = new page(pageNumber, freeFrame, currentTime);
+	page_table_entries[pageNumber] = p; //"add" page to table
+	page_table_entries[pageNumber]->valid = true; //reassert that page is valid (should have been set in constructor)
+	page_table_entries[pageNumber]->dirty = false; //reassert that page is NOT dirty yet because it was just added to the table(should have been set in constructor)
+	page_table_count++;
+	return true;
 }
 
 //Checks if a given page number is in the page table, returns true if so, false otherwise
@@ -181,73 +159,21 @@ bool PageTable::mainMemisFull() const
 	else return false;
 }
 
-//Adds page_ref to the front of the LRU list and searches through the entire list to delete duplicate entries
-//	The rear element of the LRU list will always hold the LRU page number, while the front of the list will hold
-//	the MRU page number
-void PageTable::updateLRU(int page_ref)
-{
-	//LRU_list.remove(page_ref); //remove any previous reference to this page reference
-	
-	LRU_list.push_front(page_ref); //insert this page reference as the front item (most recently used - least recently used will be the rear element of the list)
-	
-}
-
-//Returns a page number to evict based on a FIFO queue, returns -1 if the queue is empty
-int PageTable::giveFIFOtoEvict()
-{
-	if (!FIFO_queue.empty())
-	{
-		int evictedPageNum = FIFO_queue.front();
-		FIFO_queue.pop();
-		//std::cout << "FIFO queue not empty, returning page num " << evictedPageNum << "\n";
-		return evictedPageNum;
-	}
-	else return -1;
-}
-
-//Returns a page number to evict based on a LRU list, returns -1 if the list is empty
-int PageTable::giveLRUtoEvict()
-{
-	if (!LRU_list.empty())
-	{
-		int evictedPageNum = LRU_list.back();
-		LRU_list.pop_back();
-		//LRU_list.remove(evictedPageNum);
-		//std::cout << "LRU queue not empty, returning page num " << evictedPageNum << "\n";
-		return evictedPageNum;
-	}
-	else return -1;
-}
-
-//Returns a random page number to evict from the pages in the page table, returns -1 if no pages are in main memory
-int PageTable::giveRandomtoEvict()
-{
-	int randIndex = ranInt(0, random_list.size());
-	int randomPage = random_list[randIndex];
-	random_list.erase(random_list.begin()+ randIndex);
-	return randomPage;
-}
-
-//Replaces the given page_to_remove for LRU in the page table with page_replacing_removed, param time sets time at which the page was added
-void PageTable::replaceLRU(int page_to_remove, int page_replacing_removed, int time)
-{
-	//std::cout << "Removing page " << page_to_remove << " and replacing with " << page_replacing_removed << "\n";
-	removePagefromTable(page_to_remove);
-	addPagetoTableLRU(page_replacing_removed, time, giveFreeFrame());
-}
-
 //Replaces the given page_to_remove in the page table with page_replacing_removed, param time sets time at which the page was added
-void PageTable::replace(int page_to_remove, int page_replacing_removed, int time)
+void PageTable::replace(int page_to_remove, int page_replacing_removed, uint64_t time)
 {
-	//std::cout << "Removing page " << page_to_remove << " and replacing with " << page_replacing_removed << "\n";
 	removePagefromTable(page_to_remove);
 	addPagetoTable(page_replacing_removed, time, giveFreeFrame());
 }
 
-//Removes the given page from the page table
+//Removes the given page from the page table and returns its frame to the free frame list
 void PageTable::removePagefromTable(int pageNum)
 {
+	if (page_table_entries[pageNum] == NULL)
+		return;
 	free_frame_list.push(page_table_entries[pageNum]->frame_number);
+	free_frame_count = free_frame_list.size();
 	delete page_table_entries[pageNum];
 	page_table_entries[pageNum] = NULL;
+	page_table_count--;
 }
@@ -0,0 +1,185 @@
+/**************************************************************************************************************
+Purpose: This is the implementation file for the policy checker's reference models.
+
+Assumptions: See RefModel.h
+*************************************************************************************************************/
+
+#include <math.h>
+#include <algorithm>
+#include "RefModel.h"
+
+#define REF_MODEL_REBASE_EXPONENT 512.0 //rebase LRFU weights before they pass 2^this
+
+ReferenceModel::ReferenceModel(const std::string& policy, int free_frames, double lambda, int decay_period)
+{
+	if (policy == "FIFO")
+		mode = MODE_FIFO;
+	else if (policy == "LRU")
+		mode = MODE_LRU;
+	else if (policy == "LFU" || policy == "LFU-Aging")
+		mode = MODE_LFU;
+	else if (policy == "LRFU")
+		mode = MODE_LRFU;
+	else if (policy == "Random")
+		mode = MODE_RESIDENT_ONLY;
+	else mode = MODE_INVALID;
+
+	frames = free_frames;
+	current_time = 0;
+	expected_victim = -1;
+	this->lambda = lambda;
+	weight_base = 0;
+	this->decay_period = policy == "LFU-Aging" ? decay_period : 0;
+	next_decay = this->decay_period;
+	stats = SimStats();
+}
+
+bool ReferenceModel::access(int page_num, bool write, int actual_victim)
+{
+	current_time++;
+	stats.memory_references++;
+	expected_victim = -1;
+	if (mode == MODE_LRFU && lambda * (current_time - weight_base) > REF_MODEL_REBASE_EXPONENT)
+		rebaseWeights();
+	double weight = mode == MODE_LRFU ? pow(2.0, lambda * (current_time - weight_base)) : 0.0;
+
+	bool ok = true;
+	size_t i = findPage(page_num);
+	if (i < resident.size()) //hit
+	{
+		resident[i].last_time = current_time;
+		resident[i].count++;
+		resident[i].weight += weight;
+		if (write)
+			resident[i].dirty = true;
+		ok = actual_victim == -1;
+	}
+	else
+	{
+		stats.page_faults++;
+		if (frames <= 0)
+			return actual_victim == -1;
+
+		Entry loaded;
+		loaded.page_num = page_num;
+		loaded.load_time = current_time;
+		loaded.last_time = current_time;
+		loaded.count = 1;
+		loaded.weight = weight;
+		loaded.dirty = write;
+		if ((int)resident.size() < frames)
+		{
+			resident.push_back(loaded);
+			ok = actual_victim == -1;
+		}
+		else //memory is full, decide which page goes
+		{
+			size_t v;
+			if (mode == MODE_RESIDENT_ONLY)
+			{
+				v = findPage(actual_victim);
+				ok = v < resident.size();
+				if (!ok) //keep going with any page, the run is already reported as divergent
+					v = 0;
+			}
+			else
+			{
+				v = chooseVictim();
+				expected_victim = resident[v].page_num;
+				ok = actual_victim == expected_victim;
+				if (!ok && mode == MODE_LRFU)
+				{
+					//CRFs computed two ways can differ in the last bits, accept any victim that is just as cold
+					size_t a = findPage(actual_victim);
+					if (a < resident.size() && resident[a].weight <= resident[v].weight * (1.0 + REF_MODEL_CRF_TOLERANCE))
+					{
+						v = a;
+						ok = true;
+					}
+				}
+			}
+
+			if (resident[v].dirty)
+				stats.flushes++;
+			stats.page_replacements++;
+			resident[v] = loaded;
+		}
+	}
+
+	//the halving comes after the reference it is due on, as in the simulator
+	if (decay_period > 0 && current_time >= next_decay)
+		decay();
+	return ok;
+}
+
+//Straight from the definitions: FIFO evicts the page loaded first, LRU the page referenced least recently, LFU
+//	the page with the fewest references (the least recently referenced of those on a tie), and LRFU the page with
+//	the smallest combined recency and frequency
+size_t ReferenceModel::chooseVictim() const
+{
+	size_t victim = 0;
+	for (size_t i = 1; i < resident.size(); i++)
+	{
+		const Entry& e = resident[i];
+		const Entry& best = resident[victim];
+		bool better = false;
+		switch (mode)
+		{
+		case MODE_FIFO:
+			better = e.load_time < best.load_time;
+			break;
+		case MODE_LRU:
+			better = e.last_time < best.last_time;
+			break;
+		case MODE_LFU:
+			better = e.count < best.count || (e.count == best.count && e.last_time < best.last_time);
+			break;
+		case MODE_LRFU:
+			better = e.weight < best.weight;
+			break;
+		default:
+			break;
+		}
+		if (better)
+			victim = i;
+	}
+	return victim;
+}
+
+size_t ReferenceModel::findPage(int page_num) const
+{
+	for (size_t i = 0; i < resident.size(); i++)
+	{
+		if (resident[i].page_num == page_num)
+			return i;
+	}
+	return resident.size();
+}
+
+//Halving keeps the order of the counts, so among pages whose halved counts tie, the one that had the higher count
+//	is treated as the more recently referenced, and pages that had the same count keep their recency order. The
+//	pages are numbered in that order (count, then last reference) and the numbers become their new last_time;
+//	every later reference is at a larger time than the resident page count, so it stays the most recent
+void ReferenceModel::decay()
+{
+	std::vector<std::pair<uint64_t, uint64_t> > order; //(count, last_time) of each resident page
+	for (size_t i = 0; i < resident.size(); i++)
+		order.push_back(std::make_pair(resident[i].count, resident[i].last_time));
+	std::sort(order.begin(), order.end());
+	for (size_t i = 0; i < resident.size(); i++)
+	{
+		std::pair<uint64_t, uint64_t> key(resident[i].count, resident[i].last_time);
+		resident[i].last_time = std::lower_bound(order.begin(), order.end(), key) - order.begin();
+		resident[i].count = resident[i].count / 2 < 1 ? 1 : resident[i].count / 2;
+	}
+	next_decay = current_time + decay_period;
+}
+
+//Every resident weight is scaled by the same factor, so the order of the pages does not change
+void ReferenceModel::rebaseWeights()
+{
+	double scale = pow(2.0, -lambda * (current_time - weight_base));
+	for (size_t i = 0; i < resident.size(); i++)
+		resident[i].weight *= scale;
+	weight_base = current_time;
+}
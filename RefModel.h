@@ -0,0 +1,82 @@
+/**************************************************************************************************************
+Purpose: This is the header file for the reference models used by the policy checker (policycheck). A reference
+	model keeps the resident pages in a plain vector and finds each victim by scanning it, straight from the
+	definition of the replacement algorithm, so it is slow but easy to trust. The checker runs it in lockstep with
+	the optimized simulator and compares the victim of every replacement.
+
+Assumptions: Only valid page numbers are passed in. Random has no single correct victim, so for it the model
+	only checks that the simulator evicted a resident page and that the fault accounting agrees. LFU with aging
+	halves every count once per decay period; pages whose halved counts tie are ordered by their old counts,
+	the page that had the higher count counting as the more recently referenced. This class depends on:
+			PageSim.h
+*************************************************************************************************************/
+
+#ifndef _REF_MODEL
+#define _REF_MODEL
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "PageSim.h"
+
+#define REF_MODEL_CRF_TOLERANCE 1e-6 //relative CRF difference below which two LRFU victims are equally good
+
+//This class is the reference model of one replacement algorithm
+class ReferenceModel
+{
+public:
+	//@param policy - replacement algorithm name, see createSimulator in PageSim.h
+	//@param lambda - LRFU weight of recency, must match the simulator under test
+	//@param decay_period - references between halvings for LFU with aging, must match the simulator under test
+	ReferenceModel(const std::string& policy, int free_frames, double lambda, int decay_period);
+
+	//Returns false if the policy name was not known
+	bool isValid() const { return mode != MODE_INVALID; }
+	//Returns true if the model computes the victim itself, false if it only checks that the victim is resident
+	bool checksVictim() const { return mode != MODE_RESIDENT_ONLY; }
+
+	//Simulates a reference to page_num alongside a simulator that evicted actual_victim (-1 for none). If the
+	//	simulator's choice is acceptable the model evicts the same page, so the two stay in lockstep
+	//@return false if the simulator evicted a page when it should not have, or the wrong page
+	bool access(int page_num, bool write, int actual_victim);
+	//Returns the victim the model chose at the last reference, -1 if it did not evict a page
+	int getExpectedVictim() const { return expected_victim; }
+	const SimStats& getStats() const { return stats; }
+
+private:
+	enum Mode { MODE_INVALID, MODE_FIFO, MODE_LRU, MODE_LFU, MODE_LRFU, MODE_RESIDENT_ONLY };
+
+	//A resident page
+	struct Entry
+	{
+		int page_num;
+		uint64_t load_time; //reference at which the page was brought in
+		uint64_t last_time; //reference at which the page was last referenced, LFU with aging renumbers these
+					//	on each halving
+		uint64_t count; //references since the page was brought in
+		double weight; //LRFU: sum of 2^(lambda * (t - weight_base)) over the reference times t
+		bool dirty;
+	};
+
+	//Returns the index of the resident entry the algorithm evicts
+	size_t chooseVictim() const;
+	//Returns the index of the resident entry for page_num, or resident.size() if it is not resident
+	size_t findPage(int page_num) const;
+	//Halves every LFU count, keeping the recency order the simulator gives pages whose counts merge
+	void decay();
+	//Scales every LRFU weight so it is relative to the current time, keeping them in range of a double
+	void rebaseWeights();
+
+	std::vector<Entry> resident;
+	SimStats stats;
+	Mode mode;
+	int frames;
+	uint64_t current_time; //same logical clock as PageSimulator
+	int expected_victim;
+	double lambda;
+	uint64_t weight_base; //time the LRFU weights are relative to
+	int decay_period; //references between LFU halvings, 0 for plain LFU
+	uint64_t next_decay; //value of current_time at which the next halving is done
+};
+
+#endif
@@ -0,0 +1,196 @@
+/**************************************************************************************************************
+Purpose: This is the implementation file for the set associative frame mapping simulator. A batch is split into
+	one SetBatch per set, keeping the order of the references, and the sets are then simulated on up to
+	threads threads. Conflict replacements are counted after every set has finished the batch, from the
+	reference number of each replacement and the reference number at which each set filled up.
+
+Assumptions: This class depends on:
+			SetAssocSim.h
+*************************************************************************************************************/
+
+#include <thread>
+#include "SetAssocSim.h"
+
+#define NOT_FILLED UINT64_MAX //fill_position of a set that still has a free frame
+
+//Setting constructor, creates one simulator per set
+SetAssocSimulator::SetAssocSimulator(const std::string& policy, int page_size, int max_virtual_mem, int free_frames,
+	int sets, int threads, int set_index_shift)
+	: page_map(page_size, max_virtual_mem)
+{
+	this->set_index_shift = set_index_shift;
+	this->threads = threads > 0 ? threads : 1;
+	number_of_sets = sets;
+	frames_per_set = sets > 0 ? free_frames / sets : 0;
+	reference_count = 0;
+	invalid_references = 0;
+
+	set_bits = log2Int(sets);
+
+	//each set only sees the pages that map to it, so its page table is 1/sets of the whole one
+	if (sets <= 0 || (sets & (sets - 1)) != 0 || (1 << log2Int(page_size)) != page_size)
+		return;
+	for (int s = 0; s < sets; s++)
+	{
+		PageSimulator* sim = createSimulator(policy, page_size, max_virtual_mem / sets, frames_per_set);
+		if (sim == NULL)
+			break;
+		set_sims.push_back(sim);
+	}
+	if ((int)set_sims.size() != sets)
+	{
+		for (size_t s = 0; s < set_sims.size(); s++)
+			delete set_sims[s];
+		set_sims.clear();
+		return;
+	}
+
+	batches.resize(sets);
+	reset();
+}
+
+//Destructor - deletes the set simulators
+SetAssocSimulator::~SetAssocSimulator()
+{
+	for (size_t s = 0; s < set_sims.size(); s++)
+		delete set_sims[s];
+}
+
+//Clears every set and the statistics
+void SetAssocSimulator::reset()
+{
+	for (size_t s = 0; s < set_sims.size(); s++)
+		set_sims[s]->reset();
+	//a set without frames never has a free frame
+	fill_position.assign(set_sims.size(), frames_per_set > 0 ? NOT_FILLED : 0);
+	conflict_replacements.assign(set_sims.size(), 0);
+	reference_count = 0;
+	invalid_references = 0;
+}
+
+//Simulates a batch of n references and returns the running totals
+SimStats SetAssocSimulator::access(const uint64_t* addrs, const uint8_t* is_write, size_t n)
+{
+	if (!isValid())
+		return getStats();
+
+	//partition the batch by set, keeping the order of each set's references
+	for (int s = 0; s < number_of_sets; s++)
+	{
+		batches[s].pages.clear();
+		batches[s].writes.clear();
+		batches[s].positions.clear();
+		batches[s].replacement_positions.clear();
+	}
+	int low_mask = (1 << set_index_shift) - 1;
+	for (size_t i = 0; i < n; i++)
+	{
+		//skip references outside of virtual memory
+		int page_num = page_map.pageOf(addrs[i]);
+		if (page_num < 0)
+		{
+			invalid_references++;
+			continue;
+		}
+		int s = (page_num >> set_index_shift) & (number_of_sets - 1);
+		//drop the set bits to get the page number within the set
+		int set_page = ((page_num >> (set_index_shift + set_bits)) << set_index_shift) | (page_num & low_mask);
+		batches[s].pages.push_back(set_page);
+		batches[s].writes.push_back(is_write != NULL && is_write[i] != 0);
+		batches[s].positions.push_back(reference_count++);
+	}
+
+	//the sets share no state, so each thread simulates every threads-th set
+	int thread_count = threads < number_of_sets ? threads : number_of_sets;
+	if (thread_count <= 1)
+		simulateSets(0, 1);
+	else
+	{
+		std::vector<std::thread> workers;
+		for (int t = 1; t < thread_count; t++)
+			workers.push_back(std::thread(&SetAssocSimulator::simulateSets, this, t, thread_count));
+		simulateSets(0, thread_count);
+		for (size_t t = 0; t < workers.size(); t++)
+			workers[t].join();
+	}
+
+	//a replacement is a conflict if any other set still had a free frame when it was made
+	uint64_t latest = 0, second_latest = 0;
+	int latest_set = -1;
+	for (int s = 0; s < number_of_sets; s++)
+	{
+		if (fill_position[s] >= latest)
+		{
+			second_latest = latest;
+			latest = fill_position[s];
+			latest_set = s;
+		}
+		else if (fill_position[s] > second_latest)
+			second_latest = fill_position[s];
+	}
+	for (int s = 0; s < number_of_sets; s++)
+	{
+		uint64_t others_filled = (s == latest_set) ? second_latest : latest;
+		const std::vector<uint64_t>& replacements = batches[s].replacement_positions;
+		for (size_t r = 0; r < replacements.size(); r++)
+			if (replacements[r] < others_filled)
+				conflict_replacements[s]++;
+	}
+	return getStats();
+}
+
+//Simulates the batches of sets first, first + step, first + 2 * step, ...
+void SetAssocSimulator::simulateSets(int first, int step)
+{
+	for (int s = first; s < number_of_sets; s += step)
+		simulateSet(s);
+}
+
+//Simulates the batch of set s, recording when the set fills up and when it makes a replacement
+void SetAssocSimulator::simulateSet(int s)
+{
+	PageSimulator* sim = set_sims[s];
+	SetBatch& batch = batches[s];
+	for (size_t i = 0; i < batch.pages.size(); i++)
+	{
+		uint64_t replacements = sim->getStats().page_replacements;
+		sim->accessPage(batch.pages[i], batch.writes[i] != 0);
+		const SimStats& stats = sim->getStats();
+
+		if (stats.page_replacements != replacements)
+			batch.replacement_positions.push_back(batch.positions[i]);
+		else if (fill_position[s] == NOT_FILLED && stats.page_faults - stats.page_replacements == (uint64_t)frames_per_set)
+			fill_position[s] = batch.positions[i];
+	}
+}
+
+//Returns the totals over every set
+SimStats SetAssocSimulator::getStats() const
+{
+	SimStats total = SimStats();
+	for (size_t s = 0; s < set_sims.size(); s++)
+	{
+		const SimStats& stats = set_sims[s]->getStats();
+		total.memory_references += stats.memory_references;
+		total.page_faults += stats.page_faults;
+		total.page_replacements += stats.page_replacements;
+		total.flushes += stats.flushes;
+	}
+	total.invalid_references = invalid_references;
+	return total;
+}
+
+//Returns the statistics of set s
+SetStats SetAssocSimulator::getSetStats(int s) const
+{
+	SetStats set = SetStats();
+	if (s < 0 || s >= (int)set_sims.size())
+		return set;
+	const SimStats& stats = set_sims[s]->getStats();
+	set.memory_references = stats.memory_references;
+	set.page_faults = stats.page_faults;
+	set.page_replacements = stats.page_replacements;
+	set.conflict_replacements = conflict_replacements[s];
+	set.flushes = stats.flushes;
+	return set;
+}
@@ -0,0 +1,92 @@
+/**************************************************************************************************************
+Purpose: This is the header file for the set associative frame mapping simulator. It models page coloured or
+	set associative caches in front of memory: the frames are split into S sets and a page can only be placed
+	in the set selected by S bits of its page number. Each set is its own PageSimulator over the pages that map
+	to it, so replacement runs independently per set. Since the sets share no state, each batch of references
+	is partitioned by set and the sets are simulated on separate threads.
+
+Assumptions: The number of sets is a power of 2 and frames are divided evenly between the sets, any remainder
+	is left unused. This class does no I/O. This class depends on:
+			PageSim.h
+*************************************************************************************************************/
+
+#ifndef _SET_ASSOC_SIM
+#define _SET_ASSOC_SIM
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "PageSim.h"
+
+//Statistics of one set
+struct SetStats
+{
+	uint64_t memory_references; //references to pages that map to this set
+	uint64_t page_faults; //page faults in this set
+	uint64_t page_replacements; //replacements in this set
+	uint64_t conflict_replacements; //replacements made while another set still had a free frame
+	uint64_t flushes; //replacements in this set whose victim page was dirty
+};
+
+//This class simulates physical memory split into sets, each with its own replacement algorithm instance
+class SetAssocSimulator
+{
+public:
+	//Setting constructor:
+	//@param policy - replacement algorithm used in each set, see createSimulator in PageSim.h
+	//@param page_size - the page size in Bytes
+	//@param max_virtual_mem - the maximum virtual memory of the simulated process in Bytes
+	//@param free_frames - the number of frames in the simulated physical memory, split evenly between the sets
+	//@param sets - the number of sets, a power of 2
+	//@param threads - the number of threads the sets are simulated on, 1 simulates on the calling thread
+	//@param set_index_shift - the set is page number bits [set_index_shift, set_index_shift + log2(sets))
+	SetAssocSimulator(const std::string& policy, int page_size, int max_virtual_mem, int free_frames, int sets,
+		int threads = 1, int set_index_shift = 0);
+	~SetAssocSimulator();
+	//Owns its per set simulators, so it cannot be copied
+	SetAssocSimulator(const SetAssocSimulator&) = delete;
+	SetAssocSimulator& operator=(const SetAssocSimulator&) = delete;
+
+	//Returns false if the policy name was not known or sets is not a power of 2, nothing is simulated then
+	bool isValid() const { return !set_sims.empty(); }
+
+	//Simulates n references, is_write may be NULL (every reference is a read). Returns the running totals
+	SimStats access(const uint64_t* addrs, const uint8_t* is_write, size_t n);
+
+	//Clears every set and the statistics
+	void reset();
+
+	//Returns the totals over every set
+	SimStats getStats() const;
+	//Returns the statistics of set s
+	SetStats getSetStats(int s) const;
+	int getNumberofSets() const { return number_of_sets; }
+	int getFramesPerSet() const { return frames_per_set; }
+
+private:
+	//The references of one batch that map to one set, and what the set did with them
+	struct SetBatch
+	{
+		std::vector<int> pages; //page numbers within the set
+		std::vector<uint8_t> writes; //write bits
+		std::vector<uint64_t> positions; //reference number of each reference in the whole trace
+		std::vector<uint64_t> replacement_positions; //reference numbers of the replacements made in this batch
+	};
+
+	//Simulates the batches of sets first, first + step, first + 2 * step, ...
+	void simulateSets(int first, int step);
+	//Simulates the batch of set s
+	void simulateSet(int s);
+
+	std::vector<PageSimulator*> set_sims; //one simulator per set
+	std::vector<SetBatch> batches; //current batch of each set
+	std::vector<uint64_t> fill_position; //reference number at which each set took its last free frame
+	std::vector<uint64_t> conflict_replacements; //conflict replacements of each set
+	int number_of_sets, set_bits, set_index_shift, frames_per_set, threads;
+	PageNumberMap page_map; //maps reference addresses to page numbers
+	uint64_t reference_count; //valid references so far, used as the reference number
+	uint64_t invalid_references;
+};
+
+#endif
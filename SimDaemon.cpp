@@ -0,0 +1,372 @@
+/**************************************************************************************************************
+Purpose: This is the implementation file for the online simulation daemon and its working set tracker.
+
+Assumptions: This class depends on:
+			SimDaemon.h
+*************************************************************************************************************/
+
+#include <errno.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "SimDaemon.h"
+
+#define SIM_INPUT_BUFFER (sizeof(SimMessageHeader) + SIM_MAX_BATCH_RECORDS * sizeof(uint64_t)) //one full batch
+#define SIM_MAX_EVENTS 64 //epoll events handled per wakeup
+#define SIM_MAX_OUTPUT 65536 //pending reply bytes at which a client is not read from until it reads its replies
+
+/*************************** Working set ***************************/
+
+WorkingSetTracker::WorkingSetTracker(int pages, int window)
+{
+	page_count.assign(pages > 0 ? pages : 0, 0);
+	recent.assign(window > 0 ? window : 1, 0);
+	this->window = recent.size();
+	reset();
+}
+
+//Clears the window
+void WorkingSetTracker::reset()
+{
+	page_count.assign(page_count.size(), 0);
+	next = 0;
+	filled = 0;
+	working_set = 0;
+}
+
+//Records a reference to page_num, dropping the oldest reference of the window
+void WorkingSetTracker::reference(int page_num)
+{
+	if (filled == recent.size())
+	{
+		if (--page_count[recent[next]] == 0)
+			working_set--;
+	}
+	else filled++;
+
+	recent[next] = page_num;
+	if (page_count[page_num]++ == 0)
+		working_set++;
+	if (++next == recent.size())
+		next = 0;
+}
+
+/*************************** Daemon ***************************/
+
+//Setting constructor, creates one simulator per policy name
+SimDaemon::SimDaemon(const std::vector<std::string>& policies, int page_size, int max_virtual_mem, int free_frames,
+	int working_set_window)
+	: working_set(max_virtual_mem / page_size, working_set_window), page_map(page_size, max_virtual_mem)
+{
+	this->page_size = page_size;
+	listen_fd = -1;
+	epoll_fd = -1;
+	stopping = false;
+	valid = !policies.empty();
+
+	for (size_t i = 0; i < policies.size(); i++)
+	{
+		PageSimulator* sim = createSimulator(policies[i], page_size, max_virtual_mem, free_frames);
+		if (sim == NULL)
+			valid = false;
+		else sims.push_back(sim);
+	}
+	addrs.reserve(SIM_MAX_BATCH_RECORDS);
+	writes.reserve(SIM_MAX_BATCH_RECORDS);
+}
+
+//Destructor - closes every socket and removes the socket file
+SimDaemon::~SimDaemon()
+{
+	while (!clients.empty())
+		closeClient(clients.begin()->first);
+	if (listen_fd >= 0)
+	{
+		close(listen_fd);
+		unlink(socket_path.c_str());
+	}
+	if (epoll_fd >= 0)
+		close(epoll_fd);
+	for (size_t i = 0; i < sims.size(); i++)
+		delete sims[i];
+}
+
+//Binds and listens on socketPath
+bool SimDaemon::listenOn(const char* socketPath)
+{
+	sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (strlen(socketPath) >= sizeof(addr.sun_path))
+		return false;
+	strcpy(addr.sun_path, socketPath);
+
+	listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if (listen_fd < 0)
+		return false;
+	unlink(socketPath);
+	if (bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(listen_fd, SOMAXCONN) != 0)
+	{
+		close(listen_fd);
+		listen_fd = -1;
+		return false;
+	}
+	socket_path = socketPath;
+
+	epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if (epoll_fd < 0)
+		return false;
+	epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.fd = listen_fd;
+	return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &event) == 0;
+}
+
+//Serves clients until stopped
+bool SimDaemon::run(volatile int* stop_flag, const sigset_t* wait_mask)
+{
+	epoll_event events[SIM_MAX_EVENTS];
+	while (!stopping && (stop_flag == NULL || *stop_flag == 0))
+	{
+		int ready = epoll_pwait(epoll_fd, events, SIM_MAX_EVENTS, -1, wait_mask);
+		if (ready < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+
+		for (int i = 0; i < ready; i++)
+		{
+			int fd = events[i].data.fd;
+			if (fd == listen_fd)
+			{
+				acceptClients();
+				continue;
+			}
+
+			std::map<int, Connection>::iterator it = clients.find(fd);
+			if (it == clients.end())
+				continue;
+			bool keep = true;
+			if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+				keep = readClient(fd, it->second);
+			//once the replies are written, messages held back while the output was full can be processed
+			if (keep && (events[i].events & EPOLLOUT))
+				keep = writeClient(fd, it->second) && readClient(fd, it->second);
+			if (keep)
+				watchClient(fd, it->second);
+			else closeClient(fd);
+		}
+	}
+	return true;
+}
+
+//Accepts every pending connection
+void SimDaemon::acceptClients()
+{
+	while (true)
+	{
+		int fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd < 0)
+			return;
+
+		Connection& conn = clients[fd];
+		conn.input.resize(SIM_INPUT_BUFFER);
+		conn.input_used = 0;
+		conn.output_sent = 0;
+		//a new client's first interval starts when it connects
+		for (size_t s = 0; s < sims.size(); s++)
+			conn.interval_start.push_back(sims[s]->getStats());
+
+		epoll_event event;
+		memset(&event, 0, sizeof(event));
+		event.events = EPOLLIN;
+		event.data.fd = fd;
+		if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0)
+			closeClient(fd);
+	}
+}
+
+//Processes the messages already buffered, then reads what a client sent and processes every complete message
+bool SimDaemon::readClient(int fd, Connection& conn)
+{
+	while (true)
+	{
+		if (!processMessages(conn))
+			return false;
+		bool heldBack = conn.output.size() >= SIM_MAX_OUTPUT; //messages may be left that wait for output space
+		if (!conn.output.empty() && !writeClient(fd, conn))
+			return false;
+		//stop reading from a client that does not read its replies, so its output buffer stays bounded
+		if (conn.output.size() >= SIM_MAX_OUTPUT)
+			return true;
+		if (heldBack)
+			continue;
+
+		ssize_t got = read(fd, conn.input.data() + conn.input_used, conn.input.size() - conn.input_used);
+		if (got == 0)
+			return false; //client closed the connection
+		if (got < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return errno == EAGAIN || errno == EWOULDBLOCK;
+		}
+		conn.input_used += got;
+	}
+}
+
+//Processes every complete message in the input buffer and moves the rest to the front. Processing stops while
+//	the output buffer is full, the remaining messages are processed once the client has read its replies
+bool SimDaemon::processMessages(Connection& conn)
+{
+	size_t pos = 0;
+	while (conn.input_used - pos >= sizeof(SimMessageHeader) && conn.output.size() < SIM_MAX_OUTPUT)
+	{
+		SimMessageHeader header;
+		memcpy(&header, conn.input.data() + pos, sizeof(header));
+		if (header.length > conn.input.size() - sizeof(SimMessageHeader))
+			return false; //larger than a full batch, would not fit in the buffer
+		if (conn.input_used - pos < sizeof(SimMessageHeader) + header.length)
+			break;
+
+		const uint8_t* payload = conn.input.data() + pos + sizeof(SimMessageHeader);
+		if (header.type == SIM_MSG_BATCH)
+		{
+			if (header.length % sizeof(uint64_t) != 0)
+				return false;
+			//the payload is not necessarily 8 byte aligned in the buffer, so the records are copied out in chunks
+			uint64_t records[1024];
+			size_t n = header.length / sizeof(uint64_t);
+			for (size_t done = 0; done < n; )
+			{
+				size_t chunk = n - done < 1024 ? n - done : 1024;
+				memcpy(records, payload + done * sizeof(uint64_t), chunk * sizeof(uint64_t));
+				simulateRecords(records, chunk);
+				done += chunk;
+			}
+		}
+		else if (header.type == SIM_MSG_SNAPSHOT)
+		{
+			std::vector<uint8_t> reply;
+			makeSnapshot(reply, conn.interval_start);
+			conn.output.insert(conn.output.end(), reply.begin(), reply.end());
+		}
+		else if (header.type == SIM_MSG_RESET)
+			resetSimulators();
+		else return false;
+
+		pos += sizeof(SimMessageHeader) + header.length;
+	}
+
+	if (pos > 0)
+	{
+		memmove(conn.input.data(), conn.input.data() + pos, conn.input_used - pos);
+		conn.input_used -= pos;
+	}
+	return true;
+}
+
+//Simulates n reference records in every simulator
+void SimDaemon::simulateRecords(const uint64_t* records, size_t n)
+{
+	addrs.resize(n);
+	writes.resize(n);
+	for (size_t i = 0; i < n; i++)
+	{
+		addrs[i] = records[i] & SIM_RECORD_ADDRESS_MASK;
+		writes[i] = (records[i] & SIM_RECORD_WRITE_BIT) != 0;
+		int page_num = page_map.pageOf(addrs[i]);
+		if (page_num >= 0)
+			working_set.reference(page_num);
+	}
+	for (size_t s = 0; s < sims.size(); s++)
+		sims[s]->access(&addrs[0], &writes[0], n);
+}
+
+//Fills reply with a snapshot of every simulator and starts a new snapshot interval at interval_start
+void SimDaemon::makeSnapshot(std::vector<uint8_t>& reply, std::vector<SimStats>& interval_start)
+{
+	interval_start.resize(sims.size());
+	SimMessageHeader header;
+	header.type = SIM_MSG_SNAPSHOT_REPLY;
+	header.length = sizeof(SimSnapshotHeader) + sims.size() * sizeof(SimSnapshotEntry);
+
+	SimSnapshotHeader snapshot;
+	memset(&snapshot, 0, sizeof(snapshot));
+	snapshot.simulator_count = sims.size();
+	snapshot.page_size = page_size;
+	snapshot.working_set = working_set.getWorkingSetSize();
+	snapshot.working_set_window = working_set.getWindow();
+
+	reply.resize(sizeof(header) + header.length);
+	memcpy(&reply[0], &header, sizeof(header));
+	memcpy(&reply[sizeof(header)], &snapshot, sizeof(snapshot));
+	for (size_t s = 0; s < sims.size(); s++)
+	{
+		const SimStats& stats = sims[s]->getStats();
+		SimSnapshotEntry entry;
+		memset(&entry, 0, sizeof(entry));
+		strncpy(entry.name, sims[s]->getName(), SIM_NAME_LENGTH - 1);
+		entry.memory_references = stats.memory_references;
+		entry.page_faults = stats.page_faults;
+		entry.page_replacements = stats.page_replacements;
+		entry.flushes = stats.flushes;
+		entry.invalid_references = stats.invalid_references;
+		entry.interval_references = stats.memory_references - interval_start[s].memory_references;
+		entry.interval_faults = stats.page_faults - interval_start[s].page_faults;
+		interval_start[s] = stats;
+		memcpy(&reply[sizeof(header) + sizeof(snapshot) + s * sizeof(entry)], &entry, sizeof(entry));
+	}
+}
+
+//Resets every simulator and the working set
+void SimDaemon::resetSimulators(uint64_t start_time)
+{
+	for (size_t s = 0; s < sims.size(); s++)
+		sims[s]->reset(start_time);
+	for (std::map<int, Connection>::iterator it = clients.begin(); it != clients.end(); ++it)
+		it->second.interval_start.assign(sims.size(), SimStats());
+	working_set.reset();
+}
+
+//Writes pending output
+bool SimDaemon::writeClient(int fd, Connection& conn)
+{
+	while (conn.output_sent < conn.output.size())
+	{
+		ssize_t sent = send(fd, conn.output.data() + conn.output_sent, conn.output.size() - conn.output_sent, MSG_NOSIGNAL);
+		if (sent < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			return errno == EAGAIN || errno == EWOULDBLOCK;
+		}
+		conn.output_sent += sent;
+	}
+	conn.output.clear();
+	conn.output_sent = 0;
+	return true;
+}
+
+//Watches fd for output space only while it has output pending, and for input only while that output is small
+void SimDaemon::watchClient(int fd, const Connection& conn)
+{
+	epoll_event event;
+	memset(&event, 0, sizeof(event));
+	event.events = (conn.output.size() < SIM_MAX_OUTPUT ? EPOLLIN : 0) | (conn.output.empty() ? 0 : EPOLLOUT);
+	event.data.fd = fd;
+	epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &event);
+}
+
+void SimDaemon::closeClient(int fd)
+{
+	epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+	close(fd);
+	clients.erase(fd);
+}
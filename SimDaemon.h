@@ -0,0 +1,122 @@
+/**************************************************************************************************************
+Purpose: This is the header file for the online simulation daemon. It keeps a set of simulators resident and
+	feeds them the reference batches that clients send over a Unix domain socket (see SimProtocol.h). All
+	connections are served by one thread with epoll, so every client feeds the same simulated process and the
+	simulators need no locking. Memory is bounded: each connection has a fixed size input buffer that holds at
+	most one batch, replies stop being generated while a client has 64 KB of them unread, and the
+	working set is tracked over a fixed window of references.
+
+Assumptions: This class is Linux specific (epoll). Errors are reported through return values, the caller
+	decides what to print. This class depends on:
+			PageSim.h
+			SimProtocol.h
+*************************************************************************************************************/
+
+#ifndef _SIM_DAEMON
+#define _SIM_DAEMON
+
+#include <signal.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "PageSim.h"
+#include "SimProtocol.h"
+
+#define DEFAULT_WORKING_SET_WINDOW 100000 //references in the working set window
+
+//This class tracks the working set W(t, window): the distinct pages referenced in the last window references
+class WorkingSetTracker
+{
+public:
+	//@param pages - number of pages in virtual memory
+	//@param window - length of the window in references
+	WorkingSetTracker(int pages, int window);
+	//Records a reference to page_num
+	void reference(int page_num);
+	void reset();
+	uint64_t getWorkingSetSize() const { return working_set; }
+	uint64_t getWindow() const { return window; }
+
+private:
+	std::vector<uint32_t> page_count; //references to each page in the window
+	std::vector<int> recent; //ring buffer of the pages referenced in the window
+	size_t next; //next slot of recent to overwrite
+	size_t filled; //slots of recent in use
+	uint64_t window;
+	uint64_t working_set; //pages with a non zero count
+};
+
+//This class is the daemon's socket server and the simulators it feeds
+class SimDaemon
+{
+public:
+	//Setting constructor, creates one simulator per policy name
+	//@param policies - replacement algorithms to simulate, see createSimulator in PageSim.h
+	SimDaemon(const std::vector<std::string>& policies, int page_size, int max_virtual_mem, int free_frames,
+		int working_set_window = DEFAULT_WORKING_SET_WINDOW);
+	~SimDaemon();
+	//Owns its simulators and sockets, so it cannot be copied
+	SimDaemon(const SimDaemon&) = delete;
+	SimDaemon& operator=(const SimDaemon&) = delete;
+
+	//Returns false if a policy name was not known
+	bool isValid() const { return valid; }
+
+	//Binds and listens on socketPath (removing a stale socket file first), returns false on failure
+	bool listenOn(const char* socketPath);
+	//Serves clients until stop() is called or *stop_flag becomes non-zero, returns false on an epoll failure
+	//@param wait_mask - signal mask while waiting for events (see epoll_pwait), or NULL to keep the current one.
+	//	A caller that sets *stop_flag from a signal handler blocks that signal and passes a mask without it, so
+	//	the signal is only delivered during the wait and cannot slip in between the flag check and the wait
+	bool run(volatile int* stop_flag = NULL, const sigset_t* wait_mask = NULL);
+	//Makes run() return after the current event
+	void stop() { stopping = true; }
+
+	//Simulates n reference records (the SIM_MSG_BATCH payload format) in every simulator
+	void simulateRecords(const uint64_t* records, size_t n);
+	//Fills reply with a SIM_MSG_SNAPSHOT_REPLY message. The interval counts are measured from interval_start,
+	//	one entry per simulator (or empty for since the start), which is then set to the current statistics
+	void makeSnapshot(std::vector<uint8_t>& reply, std::vector<SimStats>& interval_start);
+	//Resets every simulator and the working set, the simulators' clocks restart at start_time
+	void resetSimulators(uint64_t start_time = 0);
+
+private:
+	//A client connection
+	struct Connection
+	{
+		std::vector<uint8_t> input; //fixed size input buffer
+		size_t input_used; //bytes of input holding unprocessed data
+		std::vector<uint8_t> output; //replies not yet written
+		size_t output_sent; //bytes of output already written
+		std::vector<SimStats> interval_start; //statistics of each simulator at this client's previous snapshot
+	};
+
+	//Accepts every pending connection
+	void acceptClients();
+	//Processes buffered messages, then reads and processes what a client sent, returns false if the connection
+	//	must be closed
+	bool readClient(int fd, Connection& conn);
+	//Processes every complete message in the input buffer until the output buffer is full, returns false on a
+	//	protocol error
+	bool processMessages(Connection& conn);
+	//Writes pending output, returns false if the connection must be closed
+	bool writeClient(int fd, Connection& conn);
+	//Updates the epoll registration of fd for whether it has output pending
+	void watchClient(int fd, const Connection& conn);
+	void closeClient(int fd);
+
+	std::vector<PageSimulator*> sims; //resident simulators
+	WorkingSetTracker working_set;
+	PageNumberMap page_map; //maps reference addresses to page numbers
+	std::vector<uint64_t> addrs; //decoded addresses of the current batch
+	std::vector<uint8_t> writes; //decoded write bits of the current batch
+	std::map<int, Connection> clients; //open connections by file descriptor
+	std::string socket_path;
+	int page_size;
+	int listen_fd, epoll_fd;
+	bool valid, stopping;
+};
+
+#endif
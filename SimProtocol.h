@@ -0,0 +1,60 @@
+/**************************************************************************************************************
+Purpose: This is the header file for the message format spoken between the simulation daemon (pagesimd) and its
+	clients over a Unix domain socket. Every message is a SimMessageHeader followed by length bytes of payload.
+
+	SIM_MSG_BATCH - client to daemon, payload is an array of uint64 reference records: the byte address in
+		bits 0-62 and the write flag in bit 63. No reply is sent.
+	SIM_MSG_SNAPSHOT - client to daemon, no payload. The daemon replies with SIM_MSG_SNAPSHOT_REPLY. The
+		interval counts are per connection, so one client's snapshots do not move another client's interval.
+	SIM_MSG_RESET - client to daemon, no payload. Resets every simulator, no reply is sent.
+	SIM_MSG_SNAPSHOT_REPLY - daemon to client, payload is a SimSnapshotHeader followed by one SimSnapshotEntry
+		per simulator.
+
+Assumptions: Both sides run on the same host, so every field is in host byte order.
+*************************************************************************************************************/
+
+#ifndef _SIM_PROTOCOL
+#define _SIM_PROTOCOL
+
+#include <stdint.h>
+
+#define SIM_MSG_BATCH 1
+#define SIM_MSG_SNAPSHOT 2
+#define SIM_MSG_RESET 3
+#define SIM_MSG_SNAPSHOT_REPLY 4
+
+#define SIM_RECORD_WRITE_BIT 0x8000000000000000ULL //write flag of a reference record
+#define SIM_RECORD_ADDRESS_MASK 0x7FFFFFFFFFFFFFFFULL //address bits of a reference record
+#define SIM_MAX_BATCH_RECORDS 65536 //largest batch the daemon accepts, bounds its per connection memory
+#define SIM_NAME_LENGTH 16 //bytes of a simulator name in a snapshot, NUL padded
+
+//Header of every message
+struct SimMessageHeader
+{
+	uint32_t type; //one of the SIM_MSG_ values
+	uint32_t length; //bytes of payload that follow
+};
+
+//Start of a snapshot reply
+struct SimSnapshotHeader
+{
+	uint32_t simulator_count; //SimSnapshotEntry records that follow
+	uint32_t page_size; //page size the daemon simulates
+	uint64_t working_set; //distinct pages referenced in the last working_set_window references
+	uint64_t working_set_window; //length of the working set window in references
+};
+
+//Statistics of one simulator in a snapshot reply
+struct SimSnapshotEntry
+{
+	char name[SIM_NAME_LENGTH]; //replacement algorithm
+	uint64_t memory_references; //total since start or the last reset
+	uint64_t page_faults;
+	uint64_t page_replacements;
+	uint64_t flushes;
+	uint64_t invalid_references;
+	uint64_t interval_references; //references since this connection's previous snapshot, connect, or reset
+	uint64_t interval_faults; //page faults over the same interval
+};
+
+#endif
@@ -0,0 +1,169 @@
+/**************************************************************************************************************
+Purpose: This is the implementation file for the multi-tier memory simulator. A page is in at most one of the
+	two page tables, its dirty bit moves with it between the tiers.
+
+Assumptions: This class depends on:
+			TieredSim.h
+*************************************************************************************************************/
+
+#include "TieredSim.h"
+
+//Setting constructor, both tiers are empty at start
+TieredSimulator::TieredSimulator(int page_size, int max_virtual_mem, int fast_frames, int slow_frames,
+	int promote_threshold, int fast_latency, int slow_latency, int fault_latency)
+	: fast_tier(page_size, max_virtual_mem, fast_frames), slow_tier(page_size, max_virtual_mem, slow_frames),
+	page_map(page_size, max_virtual_mem)
+{
+	this->page_size = page_size;
+	this->max_virtual_mem = max_virtual_mem;
+	this->fast_frames = fast_frames;
+	this->slow_frames = slow_frames;
+	this->promote_threshold = promote_threshold;
+	this->fast_latency = fast_latency;
+	this->slow_latency = slow_latency;
+	this->fault_latency = fault_latency;
+	reset();
+}
+
+//Clears both tiers, the statistics and the LRU state
+void TieredSimulator::reset()
+{
+	fast_tier.reset(page_size, max_virtual_mem, fast_frames);
+	slow_tier.reset(page_size, max_virtual_mem, slow_frames);
+	fast_LRU.clear();
+	slow_LRU.clear();
+	LRU_position.assign(fast_tier.getPageTableSize(), std::list<int>::iterator());
+	slow_references.assign(fast_tier.getPageTableSize(), 0);
+	current_time = 0;
+	stats = TieredStats();
+}
+
+//Simulates a batch of n references and returns the running statistics
+TieredStats TieredSimulator::access(const uint64_t* addrs, const uint8_t* is_write, size_t n)
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		//skip references outside of virtual memory
+		int page_num_referenced = page_map.pageOf(addrs[i]);
+		if (page_num_referenced < 0)
+		{
+			stats.total.invalid_references++;
+			continue;
+		}
+
+		reference(page_num_referenced, is_write != NULL && is_write[i] != 0);
+	}
+	return stats;
+}
+
+//Simulates one reference to page_num
+void TieredSimulator::reference(int page_num, bool write)
+{
+	current_time++;
+	stats.total.memory_references++;
+
+	PageTable* tier;
+	if (fast_tier.checkPageinTable(page_num)) //fast tier hit
+	{
+		stats.fast_hits++;
+		stats.access_cost += fast_latency;
+		fast_LRU.splice(fast_LRU.begin(), fast_LRU, LRU_position[page_num]);
+		tier = &fast_tier;
+	}
+	else if (slow_tier.checkPageinTable(page_num)) //slow tier hit, promote the page once it is hot
+	{
+		stats.slow_hits++;
+		stats.access_cost += slow_latency;
+		if (++slow_references[page_num] >= promote_threshold && fast_frames > 0)
+		{
+			promote(page_num);
+			tier = &fast_tier;
+		}
+		else
+		{
+			slow_LRU.splice(slow_LRU.begin(), slow_LRU, LRU_position[page_num]);
+			tier = &slow_tier;
+		}
+	}
+	else if (fast_frames <= 0) //no fast tier to bring the page into
+	{
+		stats.total.page_faults++;
+		stats.access_cost += fault_latency;
+		return;
+	}
+	else //page fault, bring the page into the fast tier
+	{
+		stats.total.page_faults++;
+		stats.access_cost += fault_latency;
+		if (fast_tier.mainMemisFull())
+			makeRoomInFast();
+		addToTier(fast_tier, fast_LRU, page_num, false);
+		tier = &fast_tier;
+	}
+
+	(*tier)[page_num]->last_page_access_time = current_time;
+	//if a write then the referenced page is marked dirty
+	if (write)
+		(*tier)[page_num]->dirty = true;
+}
+
+//Moves a slow tier page into the fast tier
+void TieredSimulator::promote(int page_num)
+{
+	bool dirty = removeFromTier(slow_tier, slow_LRU, page_num);
+	//the slot freed in the slow tier takes the demoted fast tier page, so this never evicts
+	if (fast_tier.mainMemisFull())
+		makeRoomInFast();
+	addToTier(fast_tier, fast_LRU, page_num, dirty);
+	stats.promotions++;
+	stats.migration_bytes += page_size;
+}
+
+//Frees a fast tier frame by demoting the fast tier LRU page to the slow tier
+void TieredSimulator::makeRoomInFast()
+{
+	int victim = fast_LRU.back();
+	bool dirty = removeFromTier(fast_tier, fast_LRU, victim);
+
+	if (slow_frames <= 0) //no slow tier, the page leaves main memory
+	{
+		if (dirty) //check if this is a flush
+			stats.total.flushes++;
+		stats.total.page_replacements++;
+		return;
+	}
+
+	if (slow_tier.mainMemisFull())
+		makeRoomInSlow();
+	addToTier(slow_tier, slow_LRU, victim, dirty);
+	slow_references[victim] = 0;
+	stats.demotions++;
+	stats.migration_bytes += page_size;
+}
+
+//Frees a slow tier frame by evicting the slow tier LRU page from main memory
+void TieredSimulator::makeRoomInSlow()
+{
+	int victim = slow_LRU.back();
+	if (removeFromTier(slow_tier, slow_LRU, victim)) //check if this is a flush
+		stats.total.flushes++;
+	stats.total.page_replacements++;
+}
+
+//Removes page_num from tier and its LRU list, returns its dirty bit
+bool TieredSimulator::removeFromTier(PageTable& tier, std::list<int>& lru, int page_num)
+{
+	bool dirty = tier[page_num]->dirty;
+	lru.erase(LRU_position[page_num]);
+	tier.removePagefromTable(page_num);
+	return dirty;
+}
+
+//Adds page_num as the MRU page of tier, keeping its dirty bit
+void TieredSimulator::addToTier(PageTable& tier, std::list<int>& lru, int page_num, bool dirty)
+{
+	tier.addPagetoTable(page_num, current_time, tier.giveFreeFrame());
+	tier[page_num]->dirty = dirty;
+	lru.push_front(page_num);
+	LRU_position[page_num] = lru.begin();
+}
@@ -0,0 +1,93 @@
+/**************************************************************************************************************
+Purpose: This is the header file for the multi-tier memory simulator. Main memory is split into a fast tier
+	(e.g. DRAM) and a slow tier (e.g. CXL or compressed memory), each with its own page table and free frame
+	list. A page fault brings the page into the fast tier. A page evicted from the fast tier is demoted to the
+	slow tier instead of being dropped, and only pages evicted from the slow tier leave main memory. A page in
+	the slow tier that is referenced promote_threshold times is promoted back to the fast tier. Both tiers use
+	LRU replacement.
+
+Assumptions: Latencies are given in nanoseconds and only used to weight the reported access cost. This class
+	does no I/O. This class depends on:
+			PageSim.h
+			PageTable.h
+*************************************************************************************************************/
+
+#ifndef _TIERED_SIM
+#define _TIERED_SIM
+
+#include <stddef.h>
+#include <stdint.h>
+#include <list>
+#include <vector>
+#include "PageSim.h"
+#include "PageTable.h"
+
+#define DEFAULT_FAST_TIER_LATENCY 100 //ns per access to the fast tier (DRAM)
+#define DEFAULT_SLOW_TIER_LATENCY 300 //ns per access to the slow tier (CXL attached memory)
+#define DEFAULT_FAULT_LATENCY 100000 //ns per page fault (page read from storage)
+
+//Statistics gathered by the tiered simulator
+struct TieredStats
+{
+	SimStats total; //page_faults are references to pages in neither tier, page_replacements are slow tier evictions
+	uint64_t fast_hits; //references to pages in the fast tier
+	uint64_t slow_hits; //references to pages in the slow tier
+	uint64_t promotions; //pages moved from the slow tier to the fast tier
+	uint64_t demotions; //pages moved from the fast tier to the slow tier
+	uint64_t migration_bytes; //bytes moved between the tiers, (promotions + demotions) * page size
+	uint64_t access_cost; //latency weighted cost of every reference in ns
+};
+
+//This class simulates a demand paged system with a fast and a slow memory tier
+class TieredSimulator
+{
+public:
+	//Setting constructor:
+	//@param page_size - the page size in Bytes
+	//@param max_virtual_mem - the maximum virtual memory of the simulated process in Bytes
+	//@param fast_frames - the number of frames in the fast tier
+	//@param slow_frames - the number of frames in the slow tier, 0 makes this a plain LRU simulation
+	//@param promote_threshold - references to a slow tier page that promote it to the fast tier
+	//@param fast_latency, slow_latency, fault_latency - cost in ns of a fast hit, a slow hit, and a page fault
+	TieredSimulator(int page_size, int max_virtual_mem, int fast_frames, int slow_frames, int promote_threshold,
+		int fast_latency = DEFAULT_FAST_TIER_LATENCY, int slow_latency = DEFAULT_SLOW_TIER_LATENCY,
+		int fault_latency = DEFAULT_FAULT_LATENCY);
+
+	//Simulates n references, is_write may be NULL (every reference is a read). Returns the running statistics
+	TieredStats access(const uint64_t* addrs, const uint8_t* is_write, size_t n);
+
+	//Clears both tiers, the statistics and the LRU state
+	void reset();
+
+	//Returns the statistics gathered since construction or the last reset()
+	const TieredStats& getStats() const { return stats; }
+
+private:
+	//Simulates one reference to page_num
+	void reference(int page_num, bool write);
+	//Moves a slow tier page into the fast tier, demoting the fast tier LRU page if it is full
+	void promote(int page_num);
+	//Frees a fast tier frame by demoting the fast tier LRU page, or evicting it if there is no slow tier
+	void makeRoomInFast();
+	//Frees a slow tier frame by evicting the slow tier LRU page
+	void makeRoomInSlow();
+	//Removes page_num from tier and its LRU list, returns its dirty bit
+	bool removeFromTier(PageTable& tier, std::list<int>& lru, int page_num);
+	//Adds page_num as the MRU page of tier and its LRU list
+	void addToTier(PageTable& tier, std::list<int>& lru, int page_num, bool dirty);
+
+	PageTable fast_tier; //page table and free frame list of the fast tier
+	PageTable slow_tier; //page table and free frame list of the slow tier
+	std::list<int> fast_LRU; //fast tier pages, front is MRU
+	std::list<int> slow_LRU; //slow tier pages, front is MRU
+	std::vector<std::list<int>::iterator> LRU_position; //position of each resident page in its tier's LRU list
+	std::vector<int> slow_references; //references to each slow tier page since it was demoted
+
+	PageNumberMap page_map; //maps reference addresses to page numbers
+	int page_size, max_virtual_mem, fast_frames, slow_frames, promote_threshold;
+	int fast_latency, slow_latency, fault_latency;
+	uint64_t current_time; //logical clock, advanced once per valid reference
+	TieredStats stats;
+};
+
+#endif
@@ -0,0 +1,572 @@
+/**************************************************************************************************************
+Purpose: This is the implementation file for the compressed trace format.
+
+	Block layout:
+		uint8 mode - TRACE_BLOCK_VARINT or TRACE_BLOCK_PACKED
+		uint8 bit width - width of each packed delta (TRACE_BLOCK_PACKED only)
+		varint - first value
+		deltas - the n - 1 zigzag deltas, as varints, or packed LSB first at the bit width followed by
+			TRACE_PACK_PADDING zero bytes so the decoder can always load 8 bytes at once
+		bitmap - ceil(n / 8) bytes of write bits, LSB first
+
+Assumptions: This class depends on:
+			TraceCodec.h
+*************************************************************************************************************/
+
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "TraceCodec.h"
+
+#define TRACE_BLOCK_VARINT 0 //deltas are stored as varints
+#define TRACE_BLOCK_PACKED 1 //deltas are stored with a fixed bit width
+#define TRACE_MAX_PACKED_WIDTH 56 //widest packed delta that a single unaligned 8 byte load always covers
+#define TRACE_PACK_PADDING 8 //zero bytes after the packed deltas
+#define TRACE_HEADER_BYTES 40 //size of the file header
+#define TRACE_INDEX_ENTRY_BYTES 24 //size of one index entry in the file
+
+//Maps a signed delta to an unsigned value with small magnitudes mapped to small values
+static inline uint64_t zigzag(uint64_t delta)
+{
+	return (delta << 1) ^ (uint64_t)((int64_t)delta >> 63);
+}
+
+//Inverse of zigzag
+static inline uint64_t unzigzag(uint64_t z)
+{
+	return (z >> 1) ^ (0 - (z & 1));
+}
+
+//Returns the number of bytes needed to store v as a varint
+static inline size_t varintSize(uint64_t v)
+{
+	size_t size = 1;
+	while (v >= 0x80)
+	{
+		v >>= 7;
+		size++;
+	}
+	return size;
+}
+
+//Appends v as a varint (7 bits per byte, high bit set on all but the last byte)
+static inline void putVarint(std::vector<uint8_t>& out, uint64_t v)
+{
+	while (v >= 0x80)
+	{
+		out.push_back((uint8_t)(v | 0x80));
+		v >>= 7;
+	}
+	out.push_back((uint8_t)v);
+}
+
+//Reads a varint at p, returns false if it runs past end
+static inline bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t& v)
+{
+	v = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		if (p >= end)
+			return false;
+		uint8_t byte = *p++;
+		v |= (uint64_t)(byte & 0x7F) << shift;
+		if (byte < 0x80)
+			return true;
+	}
+	return false;
+}
+
+//Encodes n values and their write bits as one block
+size_t encodeTraceBlock(const uint64_t* values, const uint8_t* is_write, size_t n, std::vector<uint8_t>& out)
+{
+	size_t start = out.size();
+	if (n == 0)
+		return 0;
+
+	//size the deltas both ways and keep the smaller encoding
+	size_t varint_bytes = 0;
+	uint64_t all_bits = 0;
+	for (size_t i = 1; i < n; i++)
+	{
+		uint64_t z = zigzag(values[i] - values[i - 1]);
+		varint_bytes += varintSize(z);
+		all_bits |= z;
+	}
+	int width = 0;
+	while (width < 64 && (all_bits >> width) != 0)
+		width++;
+	size_t packed_bytes = ((n - 1) * width + 7) / 8 + TRACE_PACK_PADDING;
+	bool packed = width <= TRACE_MAX_PACKED_WIDTH && packed_bytes < varint_bytes;
+
+	out.push_back(packed ? TRACE_BLOCK_PACKED : TRACE_BLOCK_VARINT);
+	out.push_back((uint8_t)(packed ? width : 0));
+	putVarint(out, values[0]);
+
+	if (packed)
+	{
+		size_t base = out.size();
+		out.resize(base + packed_bytes, 0);
+		uint8_t* p = &out[base];
+		uint64_t bitpos = 0;
+		for (size_t i = 1; i < n; i++, bitpos += width)
+		{
+			uint64_t z = zigzag(values[i] - values[i - 1]);
+			uint64_t word;
+			memcpy(&word, p + (bitpos >> 3), 8);
+			word |= z << (bitpos & 7);
+			memcpy(p + (bitpos >> 3), &word, 8);
+		}
+	}
+	else
+	{
+		for (size_t i = 1; i < n; i++)
+			putVarint(out, zigzag(values[i] - values[i - 1]));
+	}
+
+	//write bitmap
+	size_t bitmap = out.size();
+	out.resize(bitmap + (n + 7) / 8, 0);
+	if (is_write != NULL)
+	{
+		for (size_t i = 0; i < n; i++)
+			if (is_write[i])
+				out[bitmap + (i >> 3)] |= (uint8_t)(1 << (i & 7));
+	}
+	return out.size() - start;
+}
+
+//Unpacks one delta of a group of 8 packed at width W. A group is exactly W bytes long, so the byte offset and
+//	bit shift of each delta in it are constants
+template<int W, int K>
+static inline void unpackDelta(const uint8_t* p, uint64_t& value, int granularity_shift, uint64_t* out)
+{
+	uint64_t word;
+	memcpy(&word, p + K * W / 8, 8);
+	value += unzigzag((word >> (K * W % 8)) & (((uint64_t)1 << W) - 1));
+	out[K] = value << granularity_shift;
+}
+
+//Unpacks groups of 8 deltas packed at width W, adding each to value and storing the shifted running values
+template<int W>
+static void unpackDeltaGroups(const uint8_t* p, size_t groups, uint64_t& value, int granularity_shift, uint64_t* out)
+{
+	for (size_t g = 0; g < groups; g++, p += W, out += 8)
+	{
+		unpackDelta<W, 0>(p, value, granularity_shift, out);
+		unpackDelta<W, 1>(p, value, granularity_shift, out);
+		unpackDelta<W, 2>(p, value, granularity_shift, out);
+		unpackDelta<W, 3>(p, value, granularity_shift, out);
+		unpackDelta<W, 4>(p, value, granularity_shift, out);
+		unpackDelta<W, 5>(p, value, granularity_shift, out);
+		unpackDelta<W, 6>(p, value, granularity_shift, out);
+		unpackDelta<W, 7>(p, value, granularity_shift, out);
+	}
+}
+
+typedef void (*DeltaGroupUnpacker)(const uint8_t*, size_t, uint64_t&, int, uint64_t*);
+#define DELTA_GROUP_UNPACKERS(w) unpackDeltaGroups<w>, unpackDeltaGroups<w + 1>, unpackDeltaGroups<w + 2>, \
+	unpackDeltaGroups<w + 3>, unpackDeltaGroups<w + 4>, unpackDeltaGroups<w + 5>, unpackDeltaGroups<w + 6>, \
+	unpackDeltaGroups<w + 7>
+
+//Group unpacker of each packed width
+static const DeltaGroupUnpacker deltaGroupUnpackers[TRACE_MAX_PACKED_WIDTH + 1] = {
+	DELTA_GROUP_UNPACKERS(0), DELTA_GROUP_UNPACKERS(8), DELTA_GROUP_UNPACKERS(16), DELTA_GROUP_UNPACKERS(24),
+	DELTA_GROUP_UNPACKERS(32), DELTA_GROUP_UNPACKERS(40), DELTA_GROUP_UNPACKERS(48), unpackDeltaGroups<56>
+};
+
+//Spreads the 8 bits of one bitmap byte into 8 bytes of 0 or 1, bit i going to byte i in memory (little endian
+//	hosts, as for the packed deltas). The multiply copies the byte into every lane, the mask keeps bit i in lane
+//	i, and the add carries any set bit into the top of its lane without reaching the next one
+static inline uint64_t expandWriteBits(uint8_t bits)
+{
+	uint64_t lanes = (bits * 0x0101010101010101ULL) & 0x8040201008040201ULL;
+	return ((lanes + 0x7F7F7F7F7F7F7F7FULL) >> 7) & 0x0101010101010101ULL;
+}
+
+//Decodes a block of n references. Packed deltas are unpacked 8 at a time by the unpacker for their width and
+//	the write bitmap is expanded a byte at a time, only the last partial group of each is done one by one
+bool decodeTraceBlock(const uint8_t* data, size_t bytes, size_t n, int granularity_shift, uint64_t* addrs, uint8_t* is_write)
+{
+	if (n == 0)
+		return true;
+	if (bytes < 2)
+		return false;
+
+	const uint8_t* p = data + 2;
+	const uint8_t* end = data + bytes;
+	int mode = data[0];
+	int width = data[1];
+	uint64_t value;
+	if (!getVarint(p, end, value))
+		return false;
+	addrs[0] = value << granularity_shift;
+
+	if (mode == TRACE_BLOCK_PACKED)
+	{
+		if (width > TRACE_MAX_PACKED_WIDTH)
+			return false;
+		size_t packed_bytes = ((n - 1) * width + 7) / 8 + TRACE_PACK_PADDING;
+		if ((size_t)(end - p) < packed_bytes)
+			return false;
+		size_t groups = (n - 1) / 8;
+		deltaGroupUnpackers[width](p, groups, value, granularity_shift, addrs + 1);
+		uint64_t mask = width == 0 ? 0 : (~(uint64_t)0 >> (64 - width));
+		uint64_t bitpos = groups * 8 * width;
+		for (size_t i = groups * 8 + 1; i < n; i++, bitpos += width)
+		{
+			uint64_t word;
+			memcpy(&word, p + (bitpos >> 3), 8);
+			value += unzigzag((word >> (bitpos & 7)) & mask);
+			addrs[i] = value << granularity_shift;
+		}
+		p += packed_bytes;
+	}
+	else if (mode == TRACE_BLOCK_VARINT)
+	{
+		for (size_t i = 1; i < n; i++)
+		{
+			uint64_t z;
+			if (!getVarint(p, end, z))
+				return false;
+			value += unzigzag(z);
+			addrs[i] = value << granularity_shift;
+		}
+	}
+	else return false;
+
+	if ((size_t)(end - p) < (n + 7) / 8)
+		return false;
+	for (size_t j = 0; j < n / 8; j++)
+	{
+		uint64_t flags = expandWriteBits(p[j]);
+		memcpy(is_write + j * 8, &flags, 8);
+	}
+	for (size_t i = n / 8 * 8; i < n; i++)
+		is_write[i] = (p[i >> 3] >> (i & 7)) & 1;
+	return true;
+}
+
+/*************************** Writer ***************************/
+
+CompressedTraceWriter::CompressedTraceWriter()
+{
+	file = NULL;
+	ok = false;
+	granularity_shift = 0;
+	block_size = DEFAULT_TRACE_BLOCK;
+	offset = 0;
+	reference_count = 0;
+}
+
+CompressedTraceWriter::~CompressedTraceWriter()
+{
+	close();
+}
+
+//Creates the file, the header is written with placeholder counts and rewritten by close()
+bool CompressedTraceWriter::open(const char* fileName, int granularity_shift, int block_size)
+{
+	close();
+	file = fopen(fileName, "wb");
+	if (file == NULL)
+		return false;
+
+	this->granularity_shift = granularity_shift;
+	this->block_size = block_size > 0 ? block_size : DEFAULT_TRACE_BLOCK;
+	reference_count = 0;
+	values.clear();
+	writes.clear();
+	index.clear();
+
+	uint8_t header[TRACE_HEADER_BYTES];
+	memset(header, 0, sizeof(header));
+	ok = fwrite(header, sizeof(header), 1, file) == 1;
+	offset = TRACE_HEADER_BYTES;
+	return ok;
+}
+
+//Buffers n references, encoding a block whenever one is full
+bool CompressedTraceWriter::write(const uint64_t* addrs, const uint8_t* is_write, size_t n)
+{
+	if (file == NULL || !ok)
+		return false;
+
+	for (size_t i = 0; i < n; i++)
+	{
+		values.push_back(addrs[i] >> granularity_shift);
+		writes.push_back(is_write != NULL && is_write[i] != 0);
+		if (values.size() == (size_t)block_size && !flushBlock())
+			return false;
+	}
+	return true;
+}
+
+//Encodes and writes the buffered references as one block
+bool CompressedTraceWriter::flushBlock()
+{
+	if (values.empty())
+		return true;
+
+	encoded.clear();
+	encodeTraceBlock(&values[0], &writes[0], values.size(), encoded);
+	if (fwrite(&encoded[0], 1, encoded.size(), file) != encoded.size())
+	{
+		ok = false;
+		return false;
+	}
+
+	TraceBlockInfo info;
+	info.offset = offset;
+	info.first_reference = reference_count;
+	info.count = (uint32_t)values.size();
+	info.bytes = (uint32_t)encoded.size();
+	index.push_back(info);
+
+	offset += encoded.size();
+	reference_count += values.size();
+	values.clear();
+	writes.clear();
+	return true;
+}
+
+//Writes the last block, the index and the header and closes the file
+bool CompressedTraceWriter::close()
+{
+	if (file == NULL)
+		return false;
+
+	if (ok && flushBlock())
+	{
+		uint64_t index_offset = offset;
+		for (size_t b = 0; b < index.size() && ok; b++)
+		{
+			uint8_t entry[TRACE_INDEX_ENTRY_BYTES];
+			memcpy(entry, &index[b].offset, 8);
+			memcpy(entry + 8, &index[b].first_reference, 8);
+			memcpy(entry + 16, &index[b].count, 4);
+			memcpy(entry + 20, &index[b].bytes, 4);
+			ok = fwrite(entry, sizeof(entry), 1, file) == 1;
+			offset += sizeof(entry);
+		}
+
+		uint8_t header[TRACE_HEADER_BYTES];
+		uint32_t words[4] = { COMPRESSED_TRACE_MAGIC, COMPRESSED_TRACE_VERSION, (uint32_t)granularity_shift, (uint32_t)block_size };
+		uint64_t block_count = index.size();
+		memcpy(header, words, 16);
+		memcpy(header + 16, &reference_count, 8);
+		memcpy(header + 24, &block_count, 8);
+		memcpy(header + 32, &index_offset, 8);
+		if (ok)
+			ok = fseek(file, 0, SEEK_SET) == 0 && fwrite(header, sizeof(header), 1, file) == 1;
+	}
+
+	if (fclose(file) != 0)
+		ok = false;
+	file = NULL;
+	return ok;
+}
+
+/*************************** Reader ***************************/
+
+//Reads exactly bytes at offset, returns false on a short read
+static bool readAt(int fd, void* buffer, size_t bytes, uint64_t offset)
+{
+	uint8_t* p = (uint8_t*)buffer;
+	while (bytes > 0)
+	{
+		ssize_t got = pread(fd, p, bytes, (off_t)offset);
+		if (got <= 0)
+			return false;
+		p += got;
+		bytes -= got;
+		offset += got;
+	}
+	return true;
+}
+
+CompressedTraceReader::CompressedTraceReader()
+{
+	fd = -1;
+	granularity_shift = 0;
+	reference_count = 0;
+	next_block = 0;
+}
+
+CompressedTraceReader::~CompressedTraceReader()
+{
+	close();
+}
+
+//Opens the file and reads its header and index
+bool CompressedTraceReader::open(const char* fileName)
+{
+	close();
+	fd = ::open(fileName, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	uint8_t header[TRACE_HEADER_BYTES];
+	uint32_t words[4];
+	uint64_t block_count, index_offset;
+	if (!readAt(fd, header, sizeof(header), 0))
+	{
+		close();
+		return false;
+	}
+	memcpy(words, header, 16);
+	memcpy(&reference_count, header + 16, 8);
+	memcpy(&block_count, header + 24, 8);
+	memcpy(&index_offset, header + 32, 8);
+	if (words[0] != COMPRESSED_TRACE_MAGIC || words[1] != COMPRESSED_TRACE_VERSION || words[2] >= 64)
+	{
+		close();
+		return false;
+	}
+	granularity_shift = (int)words[2];
+
+	//the header counts come from the file, check that the index fits in it before allocating anything
+	struct stat st;
+	if (fstat(fd, &st) != 0 || index_offset < TRACE_HEADER_BYTES || index_offset > (uint64_t)st.st_size
+		|| block_count > ((uint64_t)st.st_size - index_offset) / TRACE_INDEX_ENTRY_BYTES)
+	{
+		close();
+		return false;
+	}
+
+	std::vector<uint8_t> entries(block_count * TRACE_INDEX_ENTRY_BYTES);
+	if (block_count > 0 && !readAt(fd, &entries[0], entries.size(), index_offset))
+	{
+		close();
+		return false;
+	}
+	index.resize(block_count);
+	uint64_t references = 0;
+	for (size_t b = 0; b < block_count; b++)
+	{
+		const uint8_t* entry = &entries[b * TRACE_INDEX_ENTRY_BYTES];
+		TraceBlockInfo& info = index[b];
+		memcpy(&info.offset, entry, 8);
+		memcpy(&info.first_reference, entry + 8, 8);
+		memcpy(&info.count, entry + 16, 4);
+		memcpy(&info.bytes, entry + 20, 4);
+		//every block lies between the header and the index, holds at least one reference, is at least as long
+		//	as its mode, width, first value and write bitmap, and starts where the previous blocks' references end
+		if (info.offset < TRACE_HEADER_BYTES || info.offset > index_offset || info.bytes > index_offset - info.offset
+			|| info.count == 0 || info.bytes < 3 + ((uint64_t)info.count + 7) / 8 || info.first_reference != references)
+		{
+			close();
+			return false;
+		}
+		references += info.count;
+	}
+	if (references != reference_count)
+	{
+		close();
+		return false;
+	}
+	next_block = 0;
+	return true;
+}
+
+//Returns true if the file starts with the compressed trace magic
+bool CompressedTraceReader::isCompressedTrace(const char* fileName)
+{
+	int file = ::open(fileName, O_RDONLY);
+	if (file < 0)
+		return false;
+	uint32_t magic;
+	bool found = readAt(file, &magic, sizeof(magic), 0) && magic == COMPRESSED_TRACE_MAGIC;
+	::close(file);
+	return found;
+}
+
+void CompressedTraceReader::close()
+{
+	if (fd >= 0)
+		::close(fd);
+	fd = -1;
+	index.clear();
+	reference_count = 0;
+	next_block = 0;
+}
+
+//Decodes block b, using a buffer local to the call so several threads can share this reader
+bool CompressedTraceReader::decodeBlock(size_t b, std::vector<uint64_t>& addrs, std::vector<uint8_t>& is_write) const
+{
+	if (fd < 0 || b >= index.size())
+		return false;
+
+	const TraceBlockInfo& info = index[b];
+	std::vector<uint8_t> data(info.bytes);
+	addrs.resize(info.count);
+	is_write.resize(info.count);
+	if (info.bytes > 0 && !readAt(fd, &data[0], info.bytes, info.offset))
+		return false;
+	if (info.count == 0)
+		return true;
+	return decodeTraceBlock(&data[0], info.bytes, info.count, granularity_shift, &addrs[0], &is_write[0]);
+}
+
+//Decodes a run of blocks, reading the file span that holds them at once and decoding each in place
+bool CompressedTraceReader::decodeRange(size_t first, size_t last, std::vector<uint64_t>& addrs, std::vector<uint8_t>& is_write) const
+{
+	addrs.clear();
+	is_write.clear();
+	if (fd < 0 || first > last || last > index.size())
+		return false;
+	if (first == last)
+		return true;
+
+	uint64_t start = index[first].offset;
+	uint64_t span = 0;
+	size_t total = 0;
+	for (size_t b = first; b < last; b++)
+	{
+		if (index[b].offset < start)
+			return false;
+		if (index[b].offset - start + index[b].bytes > span)
+			span = index[b].offset - start + index[b].bytes;
+		total += index[b].count;
+	}
+
+	std::vector<uint8_t> data(span);
+	addrs.resize(total);
+	is_write.resize(total);
+	if (span > 0 && !readAt(fd, &data[0], span, start))
+		return false;
+	size_t done = 0;
+	for (size_t b = first; b < last; b++)
+	{
+		const TraceBlockInfo& info = index[b];
+		if (info.count > 0 && !decodeTraceBlock(&data[info.offset - start], info.bytes, info.count, granularity_shift,
+			&addrs[done], &is_write[done]))
+			return false;
+		done += info.count;
+	}
+	return true;
+}
+
+//Decodes the next block in order
+bool CompressedTraceReader::readBlock(std::vector<uint64_t>& addrs, std::vector<uint8_t>& is_write)
+{
+	addrs.clear();
+	is_write.clear();
+	if (fd < 0)
+		return false;
+	if (next_block >= index.size())
+		return true;
+
+	const TraceBlockInfo& info = index[next_block++];
+	buffer.resize(info.bytes);
+	addrs.resize(info.count);
+	is_write.resize(info.count);
+	if (!readAt(fd, &buffer[0], info.bytes, info.offset)
+		|| !decodeTraceBlock(&buffer[0], info.bytes, info.count, granularity_shift, &addrs[0], &is_write[0]))
+	{
+		addrs.clear();
+		is_write.clear();
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,127 @@
+/**************************************************************************************************************
+Purpose: This is the header file for the compressed trace format. References are stored in blocks. Each block
+	holds the first value followed by the zigzag encoded deltas between consecutive values, packed either as
+	varints or with a fixed bit width (whichever is smaller for the block), and then a bitmap of the write bits.
+	An index of block offsets at the end of the file lets each block be decoded on its own, so workers can
+	decode disjoint block ranges in parallel.
+
+	File layout (host byte order):
+		header - uint32 magic, uint32 version, uint32 granularity shift, uint32 block size,
+			uint64 reference count, uint64 block count, uint64 index offset
+		blocks - see encodeTraceBlock
+		index - per block: uint64 file offset, uint64 first reference number, uint32 references, uint32 bytes
+
+Assumptions: Addresses are stored as (address >> granularity shift). With the shift set to log2 of the page
+	size the stored values are page numbers, and decoded addresses are the start of each page. The writer uses
+	C stdio, the reader uses POSIX pread so one reader can be shared by several threads. Errors are reported
+	through return values. This class depends on nothing else in the simulator.
+*************************************************************************************************************/
+
+#ifndef _TRACE_CODEC
+#define _TRACE_CODEC
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+#define COMPRESSED_TRACE_MAGIC 0x54434750 //"PGCT" in little endian, first word of a compressed trace file
+#define COMPRESSED_TRACE_VERSION 1 //version of the compressed trace file format
+#define DEFAULT_TRACE_BLOCK 65536 //references per block
+
+//Location of one block of a compressed trace
+struct TraceBlockInfo
+{
+	uint64_t offset; //file offset of the block
+	uint64_t first_reference; //number of the block's first reference in the whole trace
+	uint32_t count; //references in the block
+	uint32_t bytes; //encoded size of the block
+};
+
+//Encodes n values (already shifted) and their write bits as one block, appending it to out. is_write may be
+//	NULL. Returns the encoded size
+size_t encodeTraceBlock(const uint64_t* values, const uint8_t* is_write, size_t n, std::vector<uint8_t>& out);
+
+//Decodes a block of n references produced by encodeTraceBlock. Decoded addresses are (value << granularity_shift)
+//	and is_write[i] is set to 0 or 1. Returns false if the block is malformed
+bool decodeTraceBlock(const uint8_t* data, size_t bytes, size_t n, int granularity_shift, uint64_t* addrs, uint8_t* is_write);
+
+//Writes a compressed trace, references can be written in several calls
+class CompressedTraceWriter
+{
+public:
+	CompressedTraceWriter();
+	~CompressedTraceWriter(); //closes the file if it is still open
+
+	//Creates the file, returns false if it could not be created
+	//@param granularity_shift - low address bits dropped before encoding, log2(page size) stores page numbers
+	//@param block_size - references per block
+	bool open(const char* fileName, int granularity_shift, int block_size = DEFAULT_TRACE_BLOCK);
+	//Appends n references (is_write may be NULL), returns false on a write error
+	bool write(const uint64_t* addrs, const uint8_t* is_write, size_t n);
+	//Writes the last block, the index and the header and closes the file, returns false if any write failed
+	bool close();
+
+	//Returns the number of bytes written so far
+	uint64_t getBytesWritten() const { return offset; }
+
+private:
+	//Encodes and writes the buffered references as one block
+	bool flushBlock();
+
+	FILE* file;
+	bool ok; //false once a write has failed
+	int granularity_shift;
+	int block_size;
+	uint64_t offset; //current end of file
+	uint64_t reference_count; //references written so far
+	std::vector<uint64_t> values; //buffered values of the current block
+	std::vector<uint8_t> writes; //buffered write bits of the current block
+	std::vector<uint8_t> encoded; //encoding buffer
+	std::vector<TraceBlockInfo> index; //index of the blocks written so far
+};
+
+//Reads a compressed trace, either block by block in order or any block by number. decodeBlock() and
+//	decodeRange() are safe to call from several threads at once on the same reader
+class CompressedTraceReader
+{
+public:
+	CompressedTraceReader();
+	~CompressedTraceReader(); //closes the file if it is still open
+
+	//Opens the file and reads its header and index, returns false if it is not a compressed trace file or its
+	//	header or index does not fit the file
+	bool open(const char* fileName);
+	void close();
+
+	//Decodes block b into addrs and is_write (replacing their contents), returns false on a read error
+	bool decodeBlock(size_t b, std::vector<uint64_t>& addrs, std::vector<uint8_t>& is_write) const;
+	//Decodes blocks first to last - 1 one after another into addrs and is_write (replacing their contents) with
+	//	one read, returns false on a read error or a bad range. Workers each given a disjoint range decode a
+	//	trace in parallel
+	bool decodeRange(size_t first, size_t last, std::vector<uint64_t>& addrs, std::vector<uint8_t>& is_write) const;
+	//Decodes the next block in order into addrs and is_write (replacing their contents), which are left empty at
+	//	the end of the trace. Returns false on a read error or a malformed block
+	bool readBlock(std::vector<uint64_t>& addrs, std::vector<uint8_t>& is_write);
+	//Makes block b the next block returned by readBlock()
+	void seekBlock(size_t b) { next_block = b; }
+
+	size_t getBlockCount() const { return index.size(); }
+	const TraceBlockInfo& getBlockInfo(size_t b) const { return index[b]; }
+	uint64_t getReferenceCount() const { return reference_count; }
+	int getGranularityShift() const { return granularity_shift; }
+
+	//Returns true if the file starts with the compressed trace magic, whether or not the rest of it is valid.
+	//	Lets a caller tell a damaged compressed trace from a text trace when open() fails
+	static bool isCompressedTrace(const char* fileName);
+
+private:
+	int fd; //file descriptor, -1 if closed
+	int granularity_shift;
+	uint64_t reference_count;
+	std::vector<TraceBlockInfo> index;
+	size_t next_block; //block returned by the next readBlock()
+	std::vector<uint8_t> buffer; //encoded block buffer for readBlock()
+};
+
+#endif
@@ -0,0 +1,216 @@
+/**************************************************************************************************************
+Purpose: This is the implementation file for the trace reduction pre-pass and the reduced trace file format.
+
+	Reduced trace file layout (host byte order):
+		header - 4 x uint32: REDUCED_TRACE_MAGIC, REDUCED_TRACE_VERSION, page size, reserved (0)
+		records - 2 x uint32 each: page number, run length with the dirty flag in the high bit
+
+Assumptions: This class depends on:
+			TraceReduce.h
+*************************************************************************************************************/
+
+#include "TraceReduce.h"
+
+#define RUN_DIRTY_BIT 0x80000000u //high bit of a stored run length is the dirty flag
+#define MAX_RUN_LENGTH 0x7FFFFFFFu //longest run a single record can hold, longer runs are split
+
+//Setting constructor
+TraceReducer::TraceReducer(int page_size, int max_virtual_mem)
+	: page_map(page_size, max_virtual_mem)
+{
+	this->page_size = page_size;
+	reset();
+}
+
+//Clears the current run and the statistics
+void TraceReducer::reset()
+{
+	run_open = false;
+	current.page_num = 0;
+	current.count = 0;
+	current.dirty = false;
+	stats.input_references = 0;
+	stats.output_records = 0;
+}
+
+//Reduces n references and appends the completed records to out
+void TraceReducer::reduce(const uint64_t* addrs, const uint8_t* is_write, size_t n, std::vector<ReducedRef>& out)
+{
+	for (size_t i = 0; i < n; i++)
+	{
+		int page = page_map.pageOf(addrs[i]);
+		uint32_t page_num = page < 0 ? REDUCED_INVALID_PAGE : (uint32_t)page;
+		bool write = is_write != NULL && is_write[i] != 0;
+
+		if (run_open && current.page_num == page_num && current.count < MAX_RUN_LENGTH)
+		{
+			//same page as the previous reference, extend the run
+			current.count++;
+			if (write)
+				current.dirty = true;
+		}
+		else
+		{
+			finish(out);
+			current.page_num = page_num;
+			current.count = 1;
+			current.dirty = write;
+			run_open = true;
+		}
+	}
+	stats.input_references += n;
+}
+
+//Appends the record of the current run to out, if there is one
+void TraceReducer::finish(std::vector<ReducedRef>& out)
+{
+	if (!run_open)
+		return;
+	out.push_back(current);
+	stats.output_records++;
+	run_open = false;
+}
+
+//Returns input references per output record
+double TraceReducer::getCompressionRatio() const
+{
+	if (stats.output_records == 0)
+		return 0.0;
+	return (double)stats.input_references / (double)stats.output_records;
+}
+
+/*************************** Writer ***************************/
+
+ReducedTraceWriter::ReducedTraceWriter()
+{
+	file = NULL;
+	ok = false;
+}
+
+ReducedTraceWriter::~ReducedTraceWriter()
+{
+	close();
+}
+
+//Creates the file and writes its header
+bool ReducedTraceWriter::open(const char* fileName, int page_size)
+{
+	close();
+	file = fopen(fileName, "wb");
+	if (file == NULL)
+		return false;
+
+	uint32_t header[4] = { REDUCED_TRACE_MAGIC, REDUCED_TRACE_VERSION, (uint32_t)page_size, 0 };
+	ok = fwrite(header, sizeof(header), 1, file) == 1;
+	return ok;
+}
+
+//Appends n records
+bool ReducedTraceWriter::write(const ReducedRef* refs, size_t n)
+{
+	if (file == NULL || !ok)
+		return false;
+
+	uint32_t buffer[2 * 1024];
+	size_t i = 0;
+	while (i < n)
+	{
+		size_t chunk = 0;
+		for (; chunk < 1024 && i < n; chunk++, i++)
+		{
+			buffer[2 * chunk] = refs[i].page_num;
+			buffer[2 * chunk + 1] = refs[i].count | (refs[i].dirty ? RUN_DIRTY_BIT : 0);
+		}
+		if (fwrite(buffer, 2 * sizeof(uint32_t), chunk, file) != chunk)
+		{
+			ok = false;
+			return false;
+		}
+	}
+	return true;
+}
+
+//Closes the file
+bool ReducedTraceWriter::close()
+{
+	if (file == NULL)
+		return false;
+	if (fclose(file) != 0)
+		ok = false;
+	file = NULL;
+	return ok;
+}
+
+/*************************** Reader ***************************/
+
+ReducedTraceReader::ReducedTraceReader()
+{
+	file = NULL;
+	page_size = 0;
+	ok = false;
+}
+
+ReducedTraceReader::~ReducedTraceReader()
+{
+	close();
+}
+
+//Opens the file and checks its header
+bool ReducedTraceReader::open(const char* fileName)
+{
+	close();
+	file = fopen(fileName, "rb");
+	if (file == NULL)
+		return false;
+
+	uint32_t header[4];
+	if (fread(header, sizeof(header), 1, file) != 1 || header[0] != REDUCED_TRACE_MAGIC || header[1] != REDUCED_TRACE_VERSION)
+	{
+		close();
+		return false;
+	}
+	page_size = (int)header[2];
+	ok = true;
+	return true;
+}
+
+//Reads up to max records into out, every record must hold at least one reference
+bool ReducedTraceReader::read(std::vector<ReducedRef>& out, size_t max)
+{
+	out.clear();
+	if (file == NULL || !ok)
+		return false;
+
+	uint32_t buffer[2 * 1024];
+	while (out.size() < max)
+	{
+		size_t want = max - out.size() < 1024 ? max - out.size() : 1024;
+		size_t got = fread(buffer, 2 * sizeof(uint32_t), want, file);
+		for (size_t i = 0; i < got; i++)
+		{
+			ReducedRef ref;
+			ref.page_num = buffer[2 * i];
+			ref.count = buffer[2 * i + 1] & ~RUN_DIRTY_BIT;
+			ref.dirty = (buffer[2 * i + 1] & RUN_DIRTY_BIT) != 0;
+			if (ref.count == 0)
+				ok = false;
+			out.push_back(ref);
+		}
+		if (got < want)
+		{
+			if (ferror(file))
+				ok = false;
+			break;
+		}
+	}
+	if (!ok)
+		out.clear();
+	return ok;
+}
+
+void ReducedTraceReader::close()
+{
+	if (file != NULL)
+		fclose(file);
+	file = NULL;
+}
@@ -0,0 +1,104 @@
+/**************************************************************************************************************
+Purpose: This is the header file for the trace reduction pre-pass. The TraceReducer collapses runs of consecutive
+	references to the same page into one ReducedRef holding the run length and the merged dirty flag, so each
+	run goes through the page table once. Reduced traces can be saved to a file and loaded again for reuse.
+
+Assumptions: A reduced trace is only valid for the page size it was reduced with, the page size is stored in
+	the file header and checked when it is loaded. Reduced trace files are written in host byte order. The file
+	functions use C stdio and report errors through their return value. This class depends on:
+			PageSim.h
+*************************************************************************************************************/
+
+#ifndef _TRACE_REDUCE
+#define _TRACE_REDUCE
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include "PageSim.h"
+
+#define REDUCED_TRACE_MAGIC 0x54524750 //"PGRT" in little endian, first word of a reduced trace file
+#define REDUCED_TRACE_VERSION 1 //version of the reduced trace file format
+
+//Statistics of a reduction
+struct ReductionStats
+{
+	uint64_t input_references; //references given to the reducer
+	uint64_t output_records; //ReducedRef records produced
+};
+
+//This class collapses consecutive references to the same page. A run can span several calls to reduce(), the
+//	record of the last run is only emitted when a different page is referenced or finish() is called
+class TraceReducer
+{
+public:
+	//Setting constructor:
+	//@param page_size - the page size in Bytes the trace is reduced for
+	//@param max_virtual_mem - the maximum virtual memory in Bytes, references at or beyond it become invalid records
+	TraceReducer(int page_size, int max_virtual_mem);
+
+	//Reduces n references (is_write may be NULL) and appends the completed records to out
+	void reduce(const uint64_t* addrs, const uint8_t* is_write, size_t n, std::vector<ReducedRef>& out);
+	//Appends the record of the current run to out, if there is one
+	void finish(std::vector<ReducedRef>& out);
+	//Clears the current run and the statistics
+	void reset();
+
+	//Returns the statistics of the references reduced so far
+	const ReductionStats& getStats() const { return stats; }
+	//Returns input references per output record, 0 if nothing has been emitted
+	double getCompressionRatio() const;
+	int getPageSize() const { return page_size; }
+
+private:
+	int page_size; //page size in Bytes
+	PageNumberMap page_map; //maps reference addresses to page numbers
+	bool run_open; //true if current holds a run that has not been emitted yet
+	ReducedRef current; //the current run
+	ReductionStats stats;
+};
+
+//Writes a reduced trace to a file, records can be written in several calls
+class ReducedTraceWriter
+{
+public:
+	ReducedTraceWriter();
+	~ReducedTraceWriter(); //closes the file if it is still open
+
+	//Creates the file and writes its header, returns false if the file could not be written
+	bool open(const char* fileName, int page_size);
+	//Appends n records, returns false on a write error
+	bool write(const ReducedRef* refs, size_t n);
+	//Closes the file, returns false if any write failed
+	bool close();
+
+private:
+	FILE* file;
+	bool ok; //false once a write has failed
+};
+
+//Reads a reduced trace from a file in batches
+class ReducedTraceReader
+{
+public:
+	ReducedTraceReader();
+	~ReducedTraceReader(); //closes the file if it is still open
+
+	//Opens the file and checks its header, returns false if it is not a reduced trace file
+	bool open(const char* fileName);
+	//Reads up to max records into out (replacing its contents), out is left empty at end of file. Returns false
+	//	on a read error or a malformed record (a run length of 0), the file is not read any further after that
+	bool read(std::vector<ReducedRef>& out, size_t max);
+	void close();
+
+	//Returns the page size the trace was reduced with
+	int getPageSize() const { return page_size; }
+
+private:
+	FILE* file;
+	int page_size;
+	bool ok; //false once a read has failed
+};
+
+#endif
@@ -3,58 +3,113 @@ Written by: Alan Doose
 CS 433 HW 5
 Dec 7 2018
 
-Purpose: This program simulates 3 different page replacement algorithms - FIFO (First in First out), LRU (Least 
-	Recently Used, and a Random victim page selection algorithm. The user must specify on the command line when
-	running the program both the page size and the physical memory size to simulate. Logical memory size is
-	set to MAX_VIRTUAL_MEM 134217728 (128 MB). 
+Purpose: This program simulates 6 different page replacement algorithms - FIFO (First in First out), LRU (Least 
+	Recently Used), a Random victim page selection algorithm, LFU (Least Frequently Used), LFU with aging and
+	LRFU (Least Recently/Frequently Used). The user must specify on the command line when running the program
+	both the page size and the physical memory size to simulate, optionally followed by options that add the
+	huge page, memory tier and set associative simulations or run the algorithms from a reduced or compressed
+	trace. Logical memory size is set to MAX_VIRTUAL_MEM 134217728 (128 MB). 
 
 Assumptions: It is assumed that the user will enter real values as parameters on the command line for the page
 	size as well as the physical memory size. It is also assumed that this program will be run in a Unix
 	environment because it depends on sys/time.h
 
-Dependencies: This driver file depends on the following class files:
+Dependencies: This driver is a command line front end over the simulation library (libpagesim.a):
+		PageSim.h
+		FreqSim.h
+		HugePageSim.h
+		SetAssocSim.h
+		TieredSim.h
+		TraceCodec.h
+		TraceReduce.h
 		PageTable.h
 		page.h
-		random.h
 *************************************************************************************************************/
 
 #include <iostream>
 #include <iomanip>
 #include <fstream>
 #include <string>
+#include <vector>
+#include <stdlib.h>
 #include <sys/time.h>
-#include "PageTable.h"
+#include <thread>
+#include <time.h>
+#include "PageSim.h"
+#include "FreqSim.h"
+#include "HugePageSim.h"
+#include "SetAssocSim.h"
+#include "TieredSim.h"
+#include "TraceCodec.h"
+#include "TraceReduce.h"
 
 //Prototypes for helper functions
 bool checkPowerof2(int n);
+bool runSimulation(PageSimulator& sim, std::ifstream& fin, const char* reducedFile, const char* compressedFile);
+bool reduceReferences(std::ifstream& fin, int pageSize, const char* reducedFile);
+bool compressReferences(std::ifstream& fin, int pageSize, const char* compressedFile);
+void runHugePageSimulation(int pageSize, int numberOfFrames, std::ifstream& fin);
+template <class Simulator> void feedReferences(Simulator& sim, std::ifstream& fin);
+void printPageSizeStats(const char* label, const PageSizeStats& stats);
+void printSimulationTotals(const std::string& name, const timeval& startTime, const SimStats& stats);
+void runTieredSimulation(int pageSize, int numberOfFrames, std::ifstream& fin);
+void runSetAssocSimulation(int pageSize, int numberOfFrames, std::ifstream& fin);
 
 /***** constants, globals, and definitions *******/
-#define MAX_VIRTUAL_MEM 134217728 //maximum virtual memory is 128 MB = 134217728 Bytes (2^20 * 2^7 = 2^27 = 134217728)
+#define MAX_VIRTUAL_MEM DEFAULT_MAX_VIRTUAL_MEM //maximum virtual memory is 128 MB = 134217728 Bytes (2^20 * 2^7 = 2^27 = 134217728)
 #define MB_IN_BYTES 1048576 //1 MB = 1048576 B (2^20), this is used to convert the physical memory parameter to Bytes
-
-//Global statistic variables:
-int gMemoryReferences = 0;
-int gPageFaults = 0;
-int gPageReplacements = 0;
-int gFlushes = 0;
+#define REFERENCE_BATCH 65536 //number of references read from the input file and passed to the simulator at a time
+#define SLOW_TIER_FACTOR 4 //the "tiered" option simulates a slow tier this many times larger than physical memory
+#define TIER_PROMOTE_THRESHOLD 2 //references to a slow tier page that promote it to the fast tier
+#define SET_COUNT 16 //number of sets the "sets" option splits physical memory into
+#define REDUCED_FILE "references.reduced" //reduced trace written by the "reduce" option
+#define COMPRESSED_FILE "references.pgct" //compressed trace written by the "compress" option
 /************************************************/
 
 int main(int argc, char* argv[])
 {
   std::cout << "==========================================================================================" << std::endl;
   std::cout << "This is a simulation of different page replacement algorithms" << std::endl;
-  std::cout << "This program analyzes the efficiency of FIFO, LRU, and random page replacement algorithms" << std::endl;
+  std::cout << "This program analyzes the efficiency of FIFO, LRU, random, LFU, and LRFU page replacement algorithms" << std::endl;
   std::cout << "\twith given page and physical memory sizes passed on the command line." << std::endl;
   std::cout << "Written by: Alan Doose" << std::endl;
   std::cout << "==========================================================================================" << std::endl;
   
   
+  //check the optional arguments that come after the two required ones
+  bool hugeMode = false; //also run the mixed page size simulation
+  bool reduceMode = false; //reduce the trace first and simulate from the reduced trace
+  bool tieredMode = false; //also run the fast + slow tier simulation
+  bool compressMode = false; //compress the trace first and simulate from the compressed trace
+  bool setsMode = false; //also run the set associative simulation
+  bool validOptions = true;
+  for (int i = 3; i < argc; i++)
+    {
+      if (std::string(argv[i]) == "huge")
+	hugeMode = true;
+      else if (std::string(argv[i]) == "reduce")
+	reduceMode = true;
+      else if (std::string(argv[i]) == "tiered")
+	tieredMode = true;
+      else if (std::string(argv[i]) == "compress")
+	compressMode = true;
+      else if (std::string(argv[i]) == "sets")
+	setsMode = true;
+      else validOptions = false;
+    }
+  
   //Check input count validity
-  if (argc != 3)
+  if (argc < 3 || !validOptions)
     {
-      std::cout << "Improper program usage: You must enter exacly two command line arguments:" << std::endl;
+      std::cout << "Improper program usage: You must enter two command line arguments, optionally followed by options:" << std::endl;
       std::cout << "1st - page size in bytes between 256 and 8192 inclusive, and must be a power of 2" << std::endl;
       std::cout << "2nd - physical memory size in megabytes, must be a power of 2" << std::endl;
+      std::cout << "Optional arguments after those two:" << std::endl;
+      std::cout << "huge - also simulate the page size as base pages alongside 2 MB huge pages" << std::endl;
+      std::cout << "tiered - also simulate the physical memory as a fast tier in front of a slow tier " << SLOW_TIER_FACTOR << " times its size" << std::endl;
+      std::cout << "sets - also simulate LRU with the frames split into " << SET_COUNT << " sets indexed by the low page number bits" << std::endl;
+      std::cout << "compress - save the page numbers delta and varint compressed to " << COMPRESSED_FILE << " and simulate from it" << std::endl;
+      std::cout << "reduce - collapse repeated references to the same page, save the reduced trace to " << REDUCED_FILE << " and simulate from it" << std::endl;
     }
   else //correct number of inputs, check their value validity
     {
@@ -88,323 +143,59 @@ int main(int argc, char* argv[])
 	      std::cout << "Page Size: " << pageSize << " B" << std::endl;
 	      std::cout << "Phys Mem Size: " << physMeminBytes << " B" << std::endl;
 	      std::cout << "Number of Frames: " << numberOfFrames << std::endl;
+	      std::cout << "Page Table size: " << (MAX_VIRTUAL_MEM / pageSize) << std::endl;
 	      
-	      //create the page table with given parameters
-	      PageTable page_table(pageSize, MAX_VIRTUAL_MEM, numberOfFrames);
-	      
-	      std::cout << "Page Table size: " << page_table.getPageTableSize() << std::endl;
-	      
-	      timeval* startTime = new timeval();
-	      timeval* currentTime = new timeval(); //will be used to get elapsed time by subtracting startTime from this
-	      
-	      int nextReference = 0; //container for reading virtual memory references from the references.txt file
-	      int page_num_referenced = 0; //container for holding the computed page number from each logical address
-	      bool read = true; //checked for every reference, if this is false then it is a write reference
-	      int pageNumtoRemove = 0; //container for holding a reference to a page to be evicted
-	      
-	      /***********FIFO simulation*****************************************************************************/
-	      std::cout << "Starting Simulation for FIFO Algorithm..." << std::endl;
-	      gettimeofday(startTime, NULL); //get start time right before simulation
-	      fin >> nextReference; //grab first reference
-	      //std::cout << "First ref is: " << nextReference << std::endl;
-	      while (fin) //read until eof
+	      //reduce the trace once, all six simulations then read the reduced trace. FIFO, LRU and Random skip the
+	      //  repeated references of each run, LFU, LFU-Aging and LRFU replay them one at a time
+	      const char* reducedFile = NULL;
+	      if (reduceMode)
 		{
-		  //get page number from virtual reference address (not computing offset since not required for simulation)
-		  page_num_referenced = nextReference / pageSize;
-		  
-		  //check if this is a read or write
-		  if (nextReference % 2 == 0)
-		    read = true;
-		  else read = false;
-		  
-		  //Check if referenced memory is in the page table
-		  if (page_table.checkPageinTable(page_num_referenced))
-		    {
-		      //if a read, handle
-		      if (read)
-			{/*nothing to do!*/}
-		      else//else it is a write, handle (set dirty flag)
-			{
-			  page_table[page_num_referenced]->dirty = true;
-			}
-		      
-		    }
-		  else //handle if it is not already in page table
-		    {
-		      //check if valid reference, if not, abort
-		      if (nextReference > MAX_VIRTUAL_MEM)
-			{
-			  std::cout << "Invalid logical memory reference encountered! --> " << nextReference << " <-- Skipping this reference..." << std::endl;
-			  break;
-			}
-		      else //it is a valid memory reference, so add to table
-			{
-			  //check if no free frames
-			  if (page_table.mainMemisFull())
-			    {
-			      //if it is, replace based on FIFO (check flush on replaced page)
-			      pageNumtoRemove = page_table.giveFIFOtoEvict();
-			      
-			      if (page_table[pageNumtoRemove]->dirty) //check if this is a flush
-				gFlushes++;
-			      
-			      page_table.replace(pageNumtoRemove, page_num_referenced, 0); //time parameter set to 0 since FIFO doesn't care about time
-			      
-			      //check read or write and handle
-			      if (read)
-				{/*nothing to do!*/}
-			      else //write reference
-				{
-				  //if a write then the referenced page is marked dirty
-				  page_table[page_num_referenced]->dirty = true;
-				}
-			      gPageReplacements++;
-			    }
-			  else //else main mem is not full, add to table normally (and set page valid)
-			    {
-			      page_table.addPagetoTable(page_num_referenced, 0, page_table.giveFreeFrame()); //time parameter set to 0 since FIFO doesn't care about time
-			      //check if read or write and handle
-			      if (read)
-				{/*nothing to do!*/}
-			      else
-				{
-				  //if a write then the referenced page is marked dirty
-				  page_table[page_num_referenced]->dirty = true;
-				}
-			    }
-			}
-		      gPageFaults++; //page was not in memory so increment page fault counter
-		    }
-		  gMemoryReferences++;
-		  fin >> nextReference; //get next reference before restarting loop
-		}//END FIFO Simulation loop
-	      
-	      //Print results for FIFO
-	      gettimeofday(currentTime, NULL); //get end time
-	      int endtimeTotaluS = ((currentTime->tv_sec*1000000) + currentTime->tv_usec) - ((startTime->tv_sec*1000000) + startTime->tv_usec);
-	      int endTimeS = endtimeTotaluS / 1000000;
-	      int endTimeuS = endtimeTotaluS % 1000000;
-	      std::cout << "End of FIFO simulation\n";
-	      std::cout << "Total Time elapsed: " << endTimeS << " seconds, " << endTimeuS << " microseconds." << std::endl;
-	      std::cout << "Total memory references: " << gMemoryReferences << std::endl;
-	      std::cout << "Total page faults: " << gPageFaults << std::endl;
-	      std::cout << "Total page replacements: " << gPageReplacements << std::endl;
-	      std::cout << "Total page flushes: " << gFlushes << std::endl;
-	      std::cout << "\n\n";
-	      /***********END FIFO simulation*********************/
-	      
+		  if (reduceReferences(fin, pageSize, REDUCED_FILE))
+		    reducedFile = REDUCED_FILE;
+		  else std::cout << "Error writing " << REDUCED_FILE << " - simulating from references.txt instead" << std::endl;
+		}
 	      
-	      /***********LRU simulation START*************************/
-	      
-	      //reset the page table and physical memory states
-	      page_table.reset(pageSize, MAX_VIRTUAL_MEM, numberOfFrames);
-	      
-	      //reset Global statistic variables:
-	      gMemoryReferences = 0;
-	      gPageFaults = 0;
-	      gPageReplacements = 0;
-	      gFlushes = 0;
-	      
-	      //reset the file stream to the beginning of the references.txt file for the next algorithm
-	      fin.clear();
-	      fin.seekg(0, std::ios::beg);
-	      fin >> nextReference; //grab first reference
-		  
-	      gettimeofday(startTime, NULL); //get start time right before simulation
-	      std::cout << "Starting Simulation for LRU Algorithm...\n";
-	      while (fin) //read until eof
+	      //compress the trace once, it is used by the simulations unless a reduced trace was also made
+	      const char* compressedFile = NULL;
+	      if (compressMode)
 		{
-		  //get page number from virtual reference address (not computing offset since not required for simulation)
-		  page_num_referenced = nextReference / pageSize;
-		  
-		  //check if this is a read or write
-		  if (nextReference % 2 == 0)
-		    read = true;
-		  else read = false;
-		  
-		  //Check if referenced memory is in the page table
-		  if (page_table.checkPageinTable(page_num_referenced))
-		    {
-		      //if a read, handle
-		      if (read)
-			{/*nothing to do!*/}
-		      else//else it is a write, handle (set dirty flag)
-			{
-			  page_table[page_num_referenced]->dirty = true;
-			}
-			  //update the LRU list with this reference at the front (and search for and delete other entries of this reference later in the list)
-			  page_table.updateLRU(page_num_referenced);
-		      
-		    }
-		  else //handle if it is not already in page table
-		    {
-		      //check if valid reference, if not, abort
-		      if (nextReference > MAX_VIRTUAL_MEM)
-			{
-			  std::cout << "Invalid logical memory reference encountered! --> " << nextReference << " <-- Skipping this reference..." << std::endl;
-			  break;
-			}
-		      else //it is a valid memory reference, so add to table
-			{
-			  //check if no free frames
-			  if (page_table.mainMemisFull())
-			    {
-			      //if it is, replace based on LRU
-			      pageNumtoRemove = page_table.giveLRUtoEvict();
-			      
-			      if (page_table[pageNumtoRemove]->dirty) //check if this is a flush
-				gFlushes++;
-			      
-			      page_table.replaceLRU(pageNumtoRemove, page_num_referenced, 0);
-			      
-			      //check read or write and handle
-			      if (read)
-				{/*nothing to do!*/}
-			      else //write reference
-				{
-				  //if a write then the referenced page is marked dirty
-				  page_table[page_num_referenced]->dirty = true;
-				}
-			      gPageReplacements++;
-			    }
-			  else //else main memory is not full, add to table normally (and set page valid)
-			    {
-			      page_table.addPagetoTableLRU(page_num_referenced, 0, page_table.giveFreeFrame());
-								//check if read or write and handle
-			      if (read)
-				{/*nothing to do!*/}
-			      else
-				{
-				  //if a write then the referenced page is marked dirty
-				  page_table[page_num_referenced]->dirty = true;
-				}
-			    }
-			}
-		      gPageFaults++; //page was not in memory so increment page fault counter
-		    }
-		  gMemoryReferences++;
-		  fin >> nextReference; //get next reference before restarting loop
-		}//END LRU Simulation loop
+		  if (compressReferences(fin, pageSize, COMPRESSED_FILE))
+		    compressedFile = COMPRESSED_FILE;
+		  else std::cout << "Error writing " << COMPRESSED_FILE << " - simulating from references.txt instead" << std::endl;
+		}
 	      
-	      //Print results for LRU
-	      gettimeofday(currentTime, NULL); //get end time
-	      endtimeTotaluS = ((currentTime->tv_sec*1000000) + currentTime->tv_usec) - ((startTime->tv_sec*1000000) + startTime->tv_usec);
-          endTimeS = endtimeTotaluS / 1000000;
-          endTimeuS = endtimeTotaluS % 1000000;
-	      std::cout << "End of LRU simulation\n";
-	      std::cout << "Total Time elapsed: " << endTimeS << " seconds, " << endTimeuS << " micro seconds." << std::endl;
-	      std::cout << "Total memory references: " << gMemoryReferences << std::endl;
-	      std::cout << "Total page faults: " << gPageFaults << std::endl;
-	      std::cout << "Total page replacements: " << gPageReplacements << std::endl;
-	      std::cout << "Total page flushes: " << gFlushes << std::endl;
-	      std::cout << "\n\n";
-	      /***********END LRU simulation********************/
+	      //one simulator per algorithm, each owns its own page table
+	      FIFOSimulator fifo(pageSize, MAX_VIRTUAL_MEM, numberOfFrames);
+	      if (!runSimulation(fifo, fin, reducedFile, compressedFile))
+		return 1;
 	      
+	      LRUSimulator lru(pageSize, MAX_VIRTUAL_MEM, numberOfFrames);
+	      if (!runSimulation(lru, fin, reducedFile, compressedFile))
+		return 1;
 	      
-	      /***********Random simulation********************/
-	      //reset the page table and physical memory states
-	      page_table.reset(pageSize, MAX_VIRTUAL_MEM, numberOfFrames);
+	      RandomSimulator random(pageSize, MAX_VIRTUAL_MEM, numberOfFrames, time(NULL));
+	      if (!runSimulation(random, fin, reducedFile, compressedFile))
+		return 1;
 	      
-	      //reset Global statistic variables:
-	      gMemoryReferences = 0;
-	      gPageFaults = 0;
-	      gPageReplacements = 0;
-	      gFlushes = 0;
+	      LFUSimulator lfu(pageSize, MAX_VIRTUAL_MEM, numberOfFrames);
+	      if (!runSimulation(lfu, fin, reducedFile, compressedFile))
+		return 1;
 	      
-	      //reset the file stream to the beginning of the references.txt file for the next algorithm
-	      fin.clear();
-	      fin.seekg(0, std::ios::beg);
-	      fin >> nextReference; //grab first reference
-
-	      std::cout << "Starting Simulation for Random Algorithm:" << std::endl;
-	      gettimeofday(startTime, NULL); //get start time right before simulation
-	      while (fin) //read until eof
-		{
-		  //get page number from virtual reference address (not computing offset since not required for simulation)
-		  page_num_referenced = nextReference / pageSize;
-		  
-		  //check if this is a read or write
-		  if (nextReference % 2 == 0)
-		    read = true;
-		  else read = false;
-		  
-		  //time(&currentTime); //get current time for use in LRU algorithm
-		  
-		  //Check if referenced memory is in the page table
-		  if (page_table.checkPageinTable(page_num_referenced))
-		    {
-		      //if a read, handle
-		      if (read)
-			{/*nothing to do!*/}
-		      else//else it is a write, handle (set dirty flag)
-			{
-			  page_table[page_num_referenced]->dirty = true;
-			}
-		    }
-		  else //handle if it is not already in page table
-		    {
-		      //check if valid reference, if not, abort
-		      if (nextReference > MAX_VIRTUAL_MEM)
-			{
-			  std::cout << "Invalid logical memory reference encountered! --> " << nextReference << " <-- Skipping this reference..." << std::endl;
-			  break;
-			}
-		      else //it is a valid memory reference, so add to table
-			{
-			  //check if no free frames
-			  if (page_table.mainMemisFull())
-			    {
-			      //if it is, replace randomly
-			      pageNumtoRemove = page_table.giveRandomtoEvict();
-			      
-			      if (page_table[pageNumtoRemove]->dirty) //check if this is a flush
-				gFlushes++;
-			      
-			      page_table.replace(pageNumtoRemove, page_num_referenced, 0); //time parameter set to 0 since random doesnt care when pages were last used
-			      
-			      //check read or write and handle
-			      if (read)
-				{/*nothing to do!*/}
-			      else //write reference
-				{
-				  //if a write then the referenced page is marked dirty
-				  page_table[page_num_referenced]->dirty = true;
-				}
-			      gPageReplacements++;
-			    }
-			  else //else main memory is not full, add to table normally (and set page valid)
-			    {
-			      page_table.addPagetoTable(page_num_referenced, 0, page_table.giveFreeFrame()); //time parameter set to 0 since random doesnt care when pages were last used
-			      //check if read or write and handle
-			      if (read)
-				{/*nothing to do!*/}
-			      else
-				{
-									//if a write then the referenced page is marked dirty
-				  page_table[page_num_referenced]->dirty = true;
-				}
-			    }
-			}
-		      gPageFaults++; //page was not in memory so increment page fault counter
-					}
-		  gMemoryReferences++;
-		  fin >> nextReference; //get next reference before restarting loop
-		}//END LRU Simulation loop
+	      //counts are halved each time as many references as there are frames times DEFAULT_LFU_DECAY_FACTOR have been made
+	      LFUSimulator lfuAging(pageSize, MAX_VIRTUAL_MEM, numberOfFrames, numberOfFrames * DEFAULT_LFU_DECAY_FACTOR);
+	      if (!runSimulation(lfuAging, fin, reducedFile, compressedFile))
+		return 1;
 	      
-				 //Print results for LRU
-	      gettimeofday(currentTime, NULL); //get end time
-	      endtimeTotaluS = ((currentTime->tv_sec*1000000) + currentTime->tv_usec) - ((startTime->tv_sec*1000000) + startTime->tv_usec);
-              endTimeS = endtimeTotaluS / 1000000;
-              endTimeuS = endtimeTotaluS % 1000000;
-	      std::cout << "End of Random simulation\n";
-	      std::cout << "Total Time elapsed: " << endTimeS << " seconds, " << endTimeuS << " micro seconds." << std::endl;
-	      std::cout << "Total memory references: " << gMemoryReferences << std::endl;
-	      std::cout << "Total page faults: " << gPageFaults << std::endl;
-	      std::cout << "Total page replacements: " << gPageReplacements << std::endl;
-	      std::cout << "Total page flushes: " << gFlushes << std::endl;
-	      std::cout << "\n\n";
+	      LRFUSimulator lrfu(pageSize, MAX_VIRTUAL_MEM, numberOfFrames, DEFAULT_LRFU_LAMBDA);
+	      if (!runSimulation(lrfu, fin, reducedFile, compressedFile))
+		return 1;
 	      
-	      /***********END Random simulation***************/
+	      if (hugeMode)
+		runHugePageSimulation(pageSize, numberOfFrames, fin);
+	      if (tieredMode)
+		runTieredSimulation(pageSize, numberOfFrames, fin);
+	      if (setsMode)
+		runSetAssocSimulation(pageSize, numberOfFrames, fin);
 	    }
 	}
     }
@@ -413,6 +204,248 @@ int main(int argc, char* argv[])
   return 0;
 }
 
+//Rewinds fin and passes every reference in it to the given simulator in batches of REFERENCE_BATCH
+template <class Simulator> void feedReferences(Simulator& sim, std::ifstream& fin)
+{
+  //reset the file stream to the beginning of the references.txt file
+  fin.clear();
+  fin.seekg(0, std::ios::beg);
+  
+  std::vector<uint64_t> addrs;
+  std::vector<uint8_t> isWrite;
+  addrs.reserve(REFERENCE_BATCH);
+  isWrite.reserve(REFERENCE_BATCH);
+  
+  long long nextReference = 0; //container for reading virtual memory references from the references.txt file
+  while (fin >> nextReference) //read until eof
+    {
+      addrs.push_back((uint64_t)nextReference);
+      isWrite.push_back(nextReference % 2 != 0); //odd addresses are write references
+      if (addrs.size() == REFERENCE_BATCH)
+	{
+	  sim.access(&addrs[0], &isWrite[0], addrs.size());
+	  addrs.clear();
+	  isWrite.clear();
+	}
+    }
+  if (!addrs.empty())
+    sim.access(&addrs[0], &isWrite[0], addrs.size());
+}
+
+//Reduces every reference in fin for the given page size, saves the reduced trace to reducedFile and prints
+//  the compression ratio. Returns false if the reduced trace could not be written
+bool reduceReferences(std::ifstream& fin, int pageSize, const char* reducedFile)
+{
+  ReducedTraceWriter writer;
+  if (!writer.open(reducedFile, pageSize))
+    return false;
+  
+  //the reducer takes the place of a simulator in feedReferences, emitting records as runs complete
+  struct ReducingSink
+  {
+    TraceReducer reducer;
+    ReducedTraceWriter* writer;
+    std::vector<ReducedRef> records;
+    ReducingSink(int pageSize, ReducedTraceWriter* w) : reducer(pageSize, MAX_VIRTUAL_MEM), writer(w) {}
+    void access(const uint64_t* addrs, const uint8_t* isWrite, size_t n)
+    {
+      records.clear();
+      reducer.reduce(addrs, isWrite, n, records);
+      if (!records.empty())
+	writer->write(&records[0], records.size());
+    }
+  } sink(pageSize, &writer);
+  
+  std::cout << "Reducing references.txt..." << std::endl;
+  feedReferences(sink, fin);
+  sink.records.clear();
+  sink.reducer.finish(sink.records);
+  if (!sink.records.empty())
+    writer.write(&sink.records[0], sink.records.size());
+  if (!writer.close())
+    return false;
+  
+  const ReductionStats& stats = sink.reducer.getStats();
+  std::cout << "Reduced " << stats.input_references << " references to " << stats.output_records << " records (compression ratio "
+	    << std::fixed << std::setprecision(2) << sink.reducer.getCompressionRatio() << ")" << std::endl;
+  std::cout.unsetf(std::ios::fixed);
+  std::cout << "Reduced trace saved to " << reducedFile << "\n\n";
+  return true;
+}
+
+//Compresses every reference in fin, storing page numbers for the given page size, saves it to compressedFile
+//  and prints the compressed size. Returns false if the compressed trace could not be written
+bool compressReferences(std::ifstream& fin, int pageSize, const char* compressedFile)
+{
+  CompressedTraceWriter writer;
+  if (!writer.open(compressedFile, log2Int(pageSize)))
+    return false;
+  
+  //the writer takes the place of a simulator in feedReferences
+  struct WritingSink
+  {
+    CompressedTraceWriter* writer;
+    void access(const uint64_t* addrs, const uint8_t* isWrite, size_t n) { writer->write(addrs, isWrite, n); }
+  } sink = { &writer };
+  
+  std::cout << "Compressing references.txt..." << std::endl;
+  feedReferences(sink, fin);
+  fin.clear();
+  fin.seekg(0, std::ios::end);
+  uint64_t textBytes = fin.tellg();
+  if (!writer.close())
+    return false;
+  
+  CompressedTraceReader reader;
+  if (!reader.open(compressedFile))
+    return false;
+  std::cout << "Compressed " << reader.getReferenceCount() << " references in " << reader.getBlockCount() << " blocks to "
+	    << writer.getBytesWritten() << " B (" << textBytes << " B as text, " << reader.getReferenceCount() * 8 << " B as raw addresses)" << std::endl;
+  std::cout << "Compressed trace saved to " << compressedFile << "\n\n";
+  return true;
+}
+
+//Runs every reference through the given simulator and prints its results. References are read from
+//  reducedFile if it is not NULL, then from compressedFile if it is not NULL, otherwise from fin, which is
+//  rewound first so the same input file can be used for each algorithm. Returns false, without printing results,
+//  if the reduced or compressed trace could not be read to the end
+bool runSimulation(PageSimulator& sim, std::ifstream& fin, const char* reducedFile, const char* compressedFile)
+{
+  timeval startTime;
+  std::cout << "Starting Simulation for " << sim.getName() << " Algorithm..." << std::endl;
+  gettimeofday(&startTime, NULL); //get start time right before simulation
+  
+  ReducedTraceReader reader;
+  CompressedTraceReader compressedReader;
+  if (reducedFile != NULL && reader.open(reducedFile) && reader.getPageSize() == sim.getPageSize())
+    {
+      std::vector<ReducedRef> records;
+      bool readOk;
+      while ((readOk = reader.read(records, REFERENCE_BATCH)) && !records.empty())
+	sim.accessReduced(&records[0], records.size());
+      if (!readOk)
+	{
+	  std::cout << "Error reading " << reducedFile << " - the reduced trace is damaged, simulation stopped" << std::endl;
+	  return false;
+	}
+    }
+  else if (compressedFile != NULL)
+    {
+      std::vector<uint64_t> addrs;
+      std::vector<uint8_t> isWrite;
+      bool readOk = compressedReader.open(compressedFile);
+      while (readOk && (readOk = compressedReader.readBlock(addrs, isWrite)) && !addrs.empty())
+	sim.access(&addrs[0], &isWrite[0], addrs.size());
+      if (!readOk)
+	{
+	  std::cout << "Error reading " << compressedFile << " - the compressed trace is damaged, simulation stopped" << std::endl;
+	  return false;
+	}
+    }
+  else feedReferences(sim, fin);
+  
+  //Print results
+  printSimulationTotals(sim.getName(), startTime, sim.getStats());
+  std::cout << "\n\n";
+  return true;
+}
+
+//Prints the end of a simulation: the time elapsed since startTime and the totals in stats
+void printSimulationTotals(const std::string& name, const timeval& startTime, const SimStats& stats)
+{
+  timeval currentTime;
+  gettimeofday(&currentTime, NULL); //get end time
+  long long endtimeTotaluS = ((currentTime.tv_sec*1000000LL) + currentTime.tv_usec) - ((startTime.tv_sec*1000000LL) + startTime.tv_usec);
+  std::cout << "End of " << name << " simulation\n";
+  if (stats.invalid_references > 0)
+    std::cout << "Invalid logical memory references skipped: " << stats.invalid_references << std::endl;
+  std::cout << "Total Time elapsed: " << endtimeTotaluS / 1000000 << " seconds, " << endtimeTotaluS % 1000000 << " microseconds." << std::endl;
+  std::cout << "Total memory references: " << stats.memory_references << std::endl;
+  std::cout << "Total page faults: " << stats.page_faults << std::endl;
+  std::cout << "Total page replacements: " << stats.page_replacements << std::endl;
+  std::cout << "Total page flushes: " << stats.flushes << std::endl;
+}
+
+//Runs every reference in fin through the mixed page size simulator with pageSize base pages and 2 MB huge
+//  pages (LRU replacement), and prints the results for each page size
+void runHugePageSimulation(int pageSize, int numberOfFrames, std::ifstream& fin)
+{
+  int pagesPerHuge = DEFAULT_HUGE_PAGE_SIZE / pageSize;
+  //promote a region once half of it is resident, demote a huge page that has less than 1/8 of it referenced
+  HugePageSimulator sim(pageSize, DEFAULT_HUGE_PAGE_SIZE, MAX_VIRTUAL_MEM, numberOfFrames, pagesPerHuge / 2, pagesPerHuge / 8);
+  
+  timeval startTime;
+  std::cout << "Starting Simulation for LRU with " << DEFAULT_HUGE_PAGE_SIZE << " B huge pages..." << std::endl;
+  gettimeofday(&startTime, NULL); //get start time right before simulation
+  
+  feedReferences(sim, fin);
+  
+  HugePageStats stats = sim.getStats();
+  printSimulationTotals("huge page", startTime, stats.total);
+  std::cout << "Promotions: " << stats.promotions << ", demotions: " << stats.demotions << std::endl;
+  printPageSizeStats("Base pages", stats.base);
+  printPageSizeStats("Huge pages", stats.huge);
+  std::cout << "\n\n";
+}
+
+//Prints the statistics for one page size of the mixed page size simulation
+void printPageSizeStats(const char* label, const PageSizeStats& stats)
+{
+  std::cout << label << ": faults " << stats.faults << ", evictions " << stats.evictions << ", flushes " << stats.flushes
+	    << ", resident " << stats.resident_pages << ", TLB reach " << stats.tlb_reach << " B"
+	    << ", internal fragmentation " << stats.internal_fragmentation << " B" << std::endl;
+}
+
+//Runs every reference in fin through the tiered simulator with the physical memory as the fast tier and a slow
+//  tier SLOW_TIER_FACTOR times larger, and prints the per tier results
+void runTieredSimulation(int pageSize, int numberOfFrames, std::ifstream& fin)
+{
+  TieredSimulator sim(pageSize, MAX_VIRTUAL_MEM, numberOfFrames, numberOfFrames * SLOW_TIER_FACTOR, TIER_PROMOTE_THRESHOLD);
+  
+  timeval startTime;
+  std::cout << "Starting Simulation for LRU with a fast tier of " << numberOfFrames << " frames and a slow tier of "
+	    << numberOfFrames * SLOW_TIER_FACTOR << " frames..." << std::endl;
+  gettimeofday(&startTime, NULL); //get start time right before simulation
+  
+  feedReferences(sim, fin);
+  
+  const TieredStats& stats = sim.getStats();
+  printSimulationTotals("tiered", startTime, stats.total);
+  std::cout << "Fast tier hits: " << stats.fast_hits << ", slow tier hits: " << stats.slow_hits << std::endl;
+  std::cout << "Promotions: " << stats.promotions << ", demotions: " << stats.demotions
+	    << ", migration traffic: " << stats.migration_bytes << " B" << std::endl;
+  std::cout << "Latency weighted access cost: " << stats.access_cost << " ns";
+  if (stats.total.memory_references > 0)
+    std::cout << " (" << stats.access_cost / stats.total.memory_references << " ns per reference)";
+  std::cout << "\n\n\n";
+}
+
+//Runs every reference in fin through LRU with the frames split into SET_COUNT sets, one thread per core, and
+//  prints the totals and the statistics of each set
+void runSetAssocSimulation(int pageSize, int numberOfFrames, std::ifstream& fin)
+{
+  int threads = std::thread::hardware_concurrency();
+  SetAssocSimulator sim("LRU", pageSize, MAX_VIRTUAL_MEM, numberOfFrames, SET_COUNT, threads > 0 ? threads : 1);
+  
+  timeval startTime;
+  std::cout << "Starting Simulation for LRU with " << SET_COUNT << " sets of " << sim.getFramesPerSet() << " frames..." << std::endl;
+  gettimeofday(&startTime, NULL); //get start time right before simulation
+  
+  feedReferences(sim, fin);
+  
+  SimStats stats = sim.getStats();
+  printSimulationTotals("set associative", startTime, stats);
+  std::cout << std::setw(5) << "Set" << std::setw(14) << "References" << std::setw(12) << "Faults" << std::setw(14) << "Replacements"
+	    << std::setw(11) << "Conflicts" << std::setw(10) << "Flushes" << std::endl;
+  for (int s = 0; s < sim.getNumberofSets(); s++)
+    {
+      SetStats set = sim.getSetStats(s);
+      std::cout << std::setw(5) << s << std::setw(14) << set.memory_references << std::setw(12) << set.page_faults
+		<< std::setw(14) << set.page_replacements << std::setw(11) << set.conflict_replacements << std::setw(10) << set.flushes << std::endl;
+    }
+  std::cout << "\n\n";
+}
+
 //Helper function to check if a number is a power of 2
 bool checkPowerof2(int n)
 {
@@ -25,7 +25,7 @@ page::page()
 }
 
 //Constructor for creating a page that is being brought into the page table
-page::page(int page_n, int frame_allocated, int time)
+page::page(int page_n, int frame_allocated, uint64_t time)
 {
 	//set given values
 	dirty = false;
@@ -14,6 +14,8 @@ Assumptions: It is assumed that this data structure will be used in a Page Table
 #ifndef _PAGE
 #define _PAGE
 
+#include <stdint.h>
+
 //This class represents a page table entry in a simulation for a computer using
 //  a demand paging memory allocation scheme
 class page
@@ -22,10 +24,10 @@ public:
 	page(); //default constructor
 
 	//Setting constructor for use in simulation
-	page(int page_n, int frame_allocated, int time);
+	page(int page_n, int frame_allocated, uint64_t time);
 	~page(); //Destructor
 	
-	int last_page_access_time; //time at which the page was last accessed (in seconds)
+	uint64_t last_page_access_time; //logical time at which the page was last accessed
 	int page_num; //page number in the page table
 	int frame_number; //frame that this page is in in main memory
 	bool dirty; //true if write referenced
@@ -0,0 +1,214 @@
+/**************************************************************************************************************
+Purpose: This program is a client for the online simulation daemon (pagesimd). It streams a trace file to the
+	daemon in batches and then requests a snapshot and prints it, along with the rate at which the daemon
+	consumed the references.
+
+Assumptions: The trace file is either a compressed trace (TraceCodec.h) or a text file of decimal addresses like
+	references.txt, where odd addresses are write references.
+
+Dependencies: This driver depends on the simulation library (libpagesim.a) and:
+		SimProtocol.h
+		TraceCodec.h
+*************************************************************************************************************/
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include "SimProtocol.h"
+#include "TraceCodec.h"
+
+//Prototypes for helper functions
+bool sendAll(int fd, const void* data, size_t bytes);
+bool receiveAll(int fd, void* data, size_t bytes);
+bool sendBatch(int fd, const std::vector<uint64_t>& records);
+bool printSnapshot(int fd);
+
+int main(int argc, char* argv[])
+{
+  if (argc != 3)
+    {
+      std::cout << "Usage: pagesimc <socket path> <trace file>" << std::endl;
+      return 1;
+    }
+
+  sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (strlen(argv[1]) >= sizeof(addr.sun_path))
+    {
+      std::cout << "Socket path too long" << std::endl;
+      return 1;
+    }
+  strcpy(addr.sun_path, argv[1]);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) != 0)
+    {
+      std::cout << "Error connecting to " << argv[1] << " - ensure pagesimd is running" << std::endl;
+      return 1;
+    }
+
+  timeval startTime, currentTime;
+  gettimeofday(&startTime, NULL);
+
+  std::vector<uint64_t> records;
+  records.reserve(SIM_MAX_BATCH_RECORDS);
+  uint64_t referencesSent = 0;
+  bool ok = true;
+
+  CompressedTraceReader compressed;
+  if (CompressedTraceReader::isCompressedTrace(argv[2]))
+    {
+      std::vector<uint64_t> addrs;
+      std::vector<uint8_t> isWrite;
+      bool readOk = compressed.open(argv[2]);
+      while (ok && readOk && (readOk = compressed.readBlock(addrs, isWrite)) && !addrs.empty())
+	{
+	  //blocks can be larger than a batch
+	  for (size_t i = 0; i < addrs.size() && ok; i++)
+	    {
+	      records.push_back(addrs[i] | (isWrite[i] ? SIM_RECORD_WRITE_BIT : 0));
+	      if (records.size() == SIM_MAX_BATCH_RECORDS)
+		{
+		  ok = sendBatch(fd, records);
+		  referencesSent += records.size();
+		  records.clear();
+		}
+	    }
+	}
+      if (!readOk)
+	{
+	  //stop before the snapshot, results of a truncated trace must not look valid
+	  std::cout << "Error reading compressed trace file " << argv[2] << " - the file is damaged, " << referencesSent
+		    << " references were streamed" << std::endl;
+	  close(fd);
+	  return 1;
+	}
+    }
+  else
+    {
+      std::ifstream fin(argv[2]);
+      if (!fin)
+	{
+	  std::cout << "Error opening trace file " << argv[2] << std::endl;
+	  return 1;
+	}
+      long long nextReference;
+      while (ok && fin >> nextReference)
+	{
+	  uint64_t record = (uint64_t)nextReference & SIM_RECORD_ADDRESS_MASK;
+	  if (nextReference % 2 != 0) //odd addresses are write references
+	    record |= SIM_RECORD_WRITE_BIT;
+	  records.push_back(record);
+	  if (records.size() == SIM_MAX_BATCH_RECORDS)
+	    {
+	      ok = sendBatch(fd, records);
+	      referencesSent += records.size();
+	      records.clear();
+	    }
+	}
+    }
+  if (ok && !records.empty())
+    {
+      ok = sendBatch(fd, records);
+      referencesSent += records.size();
+    }
+
+  //the snapshot reply comes after the daemon has simulated every batch sent before it
+  if (!ok || !printSnapshot(fd))
+    {
+      std::cout << "Error talking to the daemon" << std::endl;
+      close(fd);
+      return 1;
+    }
+  gettimeofday(&currentTime, NULL);
+  long long elapseduS = ((currentTime.tv_sec*1000000LL) + currentTime.tv_usec) - ((startTime.tv_sec*1000000LL) + startTime.tv_usec);
+  std::cout << "Streamed " << referencesSent << " references in " << elapseduS / 1000000 << " seconds, " << elapseduS % 1000000 << " microseconds";
+  if (elapseduS > 0)
+    std::cout << " (" << (uint64_t)(referencesSent * 1000000.0 / elapseduS) << " references per second)";
+  std::cout << std::endl;
+  close(fd);
+  return 0;
+}
+
+//Sends one SIM_MSG_BATCH message
+bool sendBatch(int fd, const std::vector<uint64_t>& records)
+{
+  SimMessageHeader header;
+  header.type = SIM_MSG_BATCH;
+  header.length = records.size() * sizeof(uint64_t);
+  return sendAll(fd, &header, sizeof(header)) && sendAll(fd, &records[0], header.length);
+}
+
+//Requests a snapshot and prints the reply
+bool printSnapshot(int fd)
+{
+  SimMessageHeader header;
+  header.type = SIM_MSG_SNAPSHOT;
+  header.length = 0;
+  if (!sendAll(fd, &header, sizeof(header)) || !receiveAll(fd, &header, sizeof(header)) || header.type != SIM_MSG_SNAPSHOT_REPLY)
+    return false;
+
+  SimSnapshotHeader snapshot;
+  if (header.length < sizeof(snapshot) || !receiveAll(fd, &snapshot, sizeof(snapshot)))
+    return false;
+  std::cout << "Page size: " << snapshot.page_size << " B" << std::endl;
+  std::cout << "Working set: " << snapshot.working_set << " pages over the last " << snapshot.working_set_window << " references" << std::endl;
+  for (uint32_t s = 0; s < snapshot.simulator_count; s++)
+    {
+      SimSnapshotEntry entry;
+      if (!receiveAll(fd, &entry, sizeof(entry)))
+	return false;
+      entry.name[SIM_NAME_LENGTH - 1] = '\0';
+      double missRatio = entry.memory_references ? (double)entry.page_faults / entry.memory_references : 0.0;
+      double faultRate = entry.interval_references ? (double)entry.interval_faults / entry.interval_references : 0.0;
+      std::cout << entry.name << ": references " << entry.memory_references << ", faults " << entry.page_faults
+		<< ", replacements " << entry.page_replacements << ", flushes " << entry.flushes
+		<< std::fixed << std::setprecision(4) << ", miss ratio " << missRatio
+		<< ", fault rate since connecting " << faultRate << std::endl;
+      std::cout.unsetf(std::ios::fixed);
+    }
+  return true;
+}
+
+//Sends every byte of data
+bool sendAll(int fd, const void* data, size_t bytes)
+{
+  const char* p = (const char*)data;
+  while (bytes > 0)
+    {
+      ssize_t sent = send(fd, p, bytes, MSG_NOSIGNAL);
+      if (sent < 0 && errno == EINTR)
+	continue;
+      if (sent <= 0)
+	return false;
+      p += sent;
+      bytes -= sent;
+    }
+  return true;
+}
+
+//Receives exactly bytes into data
+bool receiveAll(int fd, void* data, size_t bytes)
+{
+  char* p = (char*)data;
+  while (bytes > 0)
+    {
+      ssize_t got = recv(fd, p, bytes, 0);
+      if (got < 0 && errno == EINTR)
+	continue;
+      if (got <= 0)
+	return false;
+      p += got;
+      bytes -= got;
+    }
+  return true;
+}
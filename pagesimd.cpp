@@ -0,0 +1,113 @@
+/**************************************************************************************************************
+Purpose: This program is the online simulation daemon. It keeps one simulator per replacement algorithm resident
+	and simulates the reference batches that clients stream to it over a Unix domain socket, replying with
+	fault rate, miss ratio and working set snapshots on request (see SimProtocol.h). pagesimc is a client that
+	streams a trace file to it.
+
+Assumptions: It is assumed that this program is run on Linux (epoll). The daemon runs until it receives SIGINT
+	or SIGTERM, then removes its socket file.
+
+Dependencies: This driver depends on the simulation library (libpagesim.a) and:
+		SimDaemon.h
+*************************************************************************************************************/
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <signal.h>
+#include <stdlib.h>
+#include "SimDaemon.h"
+
+//Prototypes for helper functions
+bool checkPowerof2(int n);
+void handleStopSignal(int signal_number);
+
+/***** constants, globals, and definitions *******/
+#define MB_IN_BYTES 1048576 //1 MB = 1048576 B (2^20), this is used to convert the physical memory parameter to Bytes
+
+volatile int gStopRequested = 0; //set by the signal handler to make the daemon exit
+/************************************************/
+
+int main(int argc, char* argv[])
+{
+  if (argc < 4)
+    {
+      std::cout << "Usage: pagesimd <socket path> <page size> <physical memory MB> [algorithm ...]" << std::endl;
+      std::cout << "page size in bytes between 256 and 8192 inclusive, and must be a power of 2" << std::endl;
+      std::cout << "physical memory size in megabytes, must be a power of 2" << std::endl;
+      std::cout << "algorithms are any of FIFO LRU Random LFU LFU-Aging LRFU, default is FIFO LRU" << std::endl;
+      return 1;
+    }
+
+  int pageSize = atoi(argv[2]);
+  int physicalMemoryinMB = atoi(argv[3]);
+  if (pageSize < 256 || pageSize > 8192 || !checkPowerof2(pageSize))
+    {
+      std::cout << "Invalid page size parameter passed, must be between 256 and 8192, and must be a power of 2" << std::endl;
+      return 1;
+    }
+  if (!checkPowerof2(physicalMemoryinMB))
+    {
+      std::cout << "Invalid physical memory size parameter passed, must be a power of 2" << std::endl;
+      return 1;
+    }
+
+  std::vector<std::string> policies;
+  for (int i = 4; i < argc; i++)
+    policies.push_back(argv[i]);
+  if (policies.empty())
+    {
+      policies.push_back("FIFO");
+      policies.push_back("LRU");
+    }
+
+  int numberOfFrames = (physicalMemoryinMB * MB_IN_BYTES) / pageSize;
+  SimDaemon daemon(policies, pageSize, DEFAULT_MAX_VIRTUAL_MEM, numberOfFrames);
+  if (!daemon.isValid())
+    {
+      std::cout << "Unknown replacement algorithm passed, must be one of FIFO LRU Random LFU LFU-Aging LRFU" << std::endl;
+      return 1;
+    }
+  if (!daemon.listenOn(argv[1]))
+    {
+      std::cout << "Error listening on socket " << argv[1] << std::endl;
+      return 1;
+    }
+
+  //the stop signals are blocked except while the daemon waits in epoll_pwait, which then returns with EINTR,
+  //so a signal that arrives while events are being handled is not lost until the next event
+  struct sigaction action;
+  action.sa_handler = handleStopSignal;
+  sigemptyset(&action.sa_mask);
+  action.sa_flags = 0;
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+  sigset_t stopSignals, waitMask;
+  sigemptyset(&stopSignals);
+  sigaddset(&stopSignals, SIGINT);
+  sigaddset(&stopSignals, SIGTERM);
+  sigprocmask(SIG_BLOCK, &stopSignals, &waitMask);
+
+  std::cout << "Simulating " << numberOfFrames << " frames of " << pageSize << " B, listening on " << argv[1] << std::endl;
+  if (!daemon.run(&gStopRequested, &waitMask))
+    {
+      std::cout << "Error waiting for socket events" << std::endl;
+      return 1;
+    }
+  std::cout << "Daemon stopped" << std::endl;
+  return 0;
+}
+
+//Signal handler for SIGINT and SIGTERM
+void handleStopSignal(int signal_number)
+{
+  gStopRequested = 1;
+}
+
+//Helper function to check if a number is a power of 2
+bool checkPowerof2(int n)
+{
+  if (n && (!(n&(n - 1))))
+    return true;
+  else return false;
+}
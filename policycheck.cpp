@@ -0,0 +1,662 @@
+/**************************************************************************************************************
+Purpose: This program checks the replacement algorithms for correctness and performance regressions. Each
+	optimized simulator is run in lockstep with its reference model (RefModel.h) over generated traces and any
+	recorded traces given on the command line, and the first reference where they pick a different victim is
+	reported. Each algorithm is also run through the daemon path (SimDaemon.h) with its clock started just
+	short of 2^31 and of 2^32, as in a daemon that has been up for hours, and must give the same results as
+	when started from 0. A compressed trace (TraceCodec.h) is decoded as disjoint block ranges on several
+	threads and compared with the references written. Then each simulator is timed on a larger generated trace
+	in child processes, alternating with a fixed calibration loop, which gives its references per second,
+	its throughput relative to the calibration loop and the memory it adds. The relative throughput is
+	compared with a stored baseline.
+
+Assumptions: Generated traces use fixed seeds, so every run checks the same references. Recorded traces are either
+	compressed traces (TraceCodec.h) or text files of decimal addresses like references.txt, where odd addresses
+	are write references. Dividing by the calibration loop's speed in the same process takes out most of the
+	machine's speed, but not all of the build flags' effect. The committed baseline (policycheck.baseline) was
+	measured with the Makefile's flags; after a deliberate performance change, or with other flags, refresh it
+	with "./policycheck -u" and commit the result. Memory is read from /proc/self/status. The program exits
+	with 1 if any policy diverges or regresses past the threshold, and with 2 (SKIPPED) if the checks passed but
+	a policy had no baseline to compare its throughput with.
+
+Dependencies: This driver depends on the simulation library (libpagesim.a) and:
+		RefModel.h
+		SimDaemon.h
+		TraceCodec.h
+*************************************************************************************************************/
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <map>
+#include <thread>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/wait.h>
+#include "FreqSim.h"
+#include "PageSim.h"
+#include "RefModel.h"
+#include "SimDaemon.h"
+#include "TraceCodec.h"
+
+/***** constants, globals, and definitions *******/
+#define CHECK_PAGE_SIZE 4096 //page size of every check
+#define CHECK_FRAMES 64 //frames of the lockstep checks, small so the generated traces replace often
+#define CHECK_TRACE_LENGTH 200000 //references in each generated lockstep trace
+#define LONG_RUN_TRACE_LENGTH 400000 //references of the long run check, half of them past each clock boundary
+#define LONG_RUN_BATCH 4096 //records per simulated daemon batch
+#define CODEC_TRACE_LENGTH 300000 //references of the compressed trace check
+#define CODEC_BLOCK 4096 //references per block of the compressed trace check, small so it has many blocks
+#define CODEC_SHIFT 6 //granularity shift of the compressed trace check, cache line addresses
+#define CODEC_THREADS 4 //threads decoding disjoint block ranges in the compressed trace check
+#define PERF_FRAMES 1024 //frames of the performance runs
+#define PERF_TRACE_LENGTH 2000000 //references in the performance trace
+#define PERF_CHILDREN 3 //timed child processes per policy, the fastest relative to the calibration loop is reported
+#define PERF_REPEATS 3 //timed passes in each child, the best is kept
+#define DEFAULT_BASELINE_FILE "policycheck.baseline"
+#define DEFAULT_REGRESSION_THRESHOLD 20.0 //percent of baseline throughput that may be lost
+#define EXIT_SKIPPED 2 //exit status when nothing failed but some throughput was not compared with a baseline
+
+const char* POLICIES[] = { "FIFO", "LRU", "Random", "LFU", "LFU-Aging", "LRFU" };
+const int NUM_POLICIES = sizeof(POLICIES) / sizeof(POLICIES[0]);
+
+//A trace of page references
+struct PageTrace
+{
+  std::string name;
+  std::vector<int> pages;
+  std::vector<uint8_t> writes;
+};
+
+//Timing of one policy, sent from the child process that measured it
+struct PerfResult
+{
+  double refs_per_second;
+  double relative; //refs_per_second divided by the references per second of the calibration loop
+  long memory_kb; //peak resident memory added while the simulator ran, -1 if it could not be read
+};
+/************************************************/
+
+//Prototypes for helper functions
+uint64_t nextRandom(uint64_t& state);
+double cpuSeconds();
+void generateTrace(PageTrace& trace, const std::string& kind, uint64_t seed, int length);
+bool loadTrace(PageTrace& trace, const char* fileName, int maxVirtualMem);
+bool checkPolicy(const char* policy, const PageTrace& trace);
+bool checkLongRun(const char* policy);
+bool checkCodec();
+void decodeRangeWorker(const CompressedTraceReader* reader, size_t first, size_t last, std::vector<uint64_t>* addrs,
+		       std::vector<uint8_t>* writes, char* ok);
+bool measurePolicy(const char* policy, PerfResult& result);
+bool measureInChild(const char* policy, PerfResult& result);
+void calibrationPass(const std::vector<int>& pages, std::vector<int>& next, std::vector<int>& prev);
+long statusKb(const char* field);
+bool readBaseline(const char* fileName, std::map<std::string, double>& baseline);
+bool writeBaseline(const char* fileName, const std::map<std::string, PerfResult>& results);
+
+int main(int argc, char* argv[])
+{
+  const char* baselineFile = DEFAULT_BASELINE_FILE;
+  double threshold = DEFAULT_REGRESSION_THRESHOLD;
+  bool updateBaseline = false;
+  int opt;
+  while ((opt = getopt(argc, argv, "b:t:u")) != -1)
+    {
+      if (opt == 'b')
+	baselineFile = optarg;
+      else if (opt == 't')
+	threshold = atof(optarg);
+      else if (opt == 'u')
+	updateBaseline = true;
+      else
+	{
+	  std::cout << "Usage: policycheck [-b baseline file] [-t regression threshold %] [-u] [trace file ...]" << std::endl;
+	  std::cout << "-u writes the measured throughput as the new baseline instead of comparing with it" << std::endl;
+	  return 1;
+	}
+    }
+
+  //generated traces cover the access patterns each algorithm handles differently
+  std::vector<PageTrace> traces(4);
+  generateTrace(traces[0], "uniform", 1, CHECK_TRACE_LENGTH);
+  generateTrace(traces[1], "loop", 2, CHECK_TRACE_LENGTH);
+  generateTrace(traces[2], "skewed", 3, CHECK_TRACE_LENGTH);
+  generateTrace(traces[3], "phases", 4, CHECK_TRACE_LENGTH);
+  for (int i = optind; i < argc; i++)
+    {
+      traces.push_back(PageTrace());
+      if (!loadTrace(traces.back(), argv[i], DEFAULT_MAX_VIRTUAL_MEM))
+	{
+	  std::cout << "Error reading trace file " << argv[i] << std::endl;
+	  return 1;
+	}
+    }
+
+  bool failed = false;
+  std::cout << "Lockstep check against the reference models, " << CHECK_FRAMES << " frames of " << CHECK_PAGE_SIZE << " B" << std::endl;
+  for (int p = 0; p < NUM_POLICIES; p++)
+    {
+      for (size_t t = 0; t < traces.size(); t++)
+	{
+	  if (!checkPolicy(POLICIES[p], traces[t]))
+	    failed = true;
+	}
+    }
+
+  std::cout << std::endl << "Long run check of the daemon path, clock started near 2^31 and 2^32" << std::endl;
+  for (int p = 0; p < NUM_POLICIES; p++)
+    {
+      if (!checkLongRun(POLICIES[p]))
+	failed = true;
+    }
+
+  std::cout << std::endl << "Compressed trace check, disjoint block ranges decoded on " << CODEC_THREADS << " threads" << std::endl;
+  if (!checkCodec())
+    failed = true;
+  //the timed children are forked from this process, free the traces so the children do not inherit them
+  std::vector<PageTrace>().swap(traces);
+
+  std::map<std::string, double> baseline;
+  bool haveBaseline = !updateBaseline && readBaseline(baselineFile, baseline);
+  std::map<std::string, PerfResult> results;
+  bool skipped = false;
+  std::cout << std::endl << "Performance, " << PERF_TRACE_LENGTH << " references, " << PERF_FRAMES << " frames of " << CHECK_PAGE_SIZE << " B" << std::endl;
+  for (int p = 0; p < NUM_POLICIES; p++)
+    {
+      PerfResult result;
+      if (!measurePolicy(POLICIES[p], result))
+	{
+	  std::cout << POLICIES[p] << ": error running the timed child process" << std::endl;
+	  failed = true;
+	  continue;
+	}
+      results[POLICIES[p]] = result;
+      std::cout << std::left << std::setw(10) << POLICIES[p] << std::right << std::setw(12) << (uint64_t)result.refs_per_second
+		<< " references per second, " << std::fixed << std::setprecision(3) << result.relative << " x calibration";
+      std::cout.unsetf(std::ios::fixed);
+      if (result.memory_kb >= 0)
+	std::cout << ", simulator memory " << result.memory_kb << " KB";
+      if (haveBaseline && baseline.count(POLICIES[p]))
+	{
+	  double change = 100.0 * (result.relative - baseline[POLICIES[p]]) / baseline[POLICIES[p]];
+	  std::cout << std::fixed << std::setprecision(1) << ", " << (change >= 0 ? "+" : "") << change << "% against baseline";
+	  std::cout.unsetf(std::ios::fixed);
+	  if (change < -threshold)
+	    {
+	      std::cout << " REGRESSION";
+	      failed = true;
+	    }
+	}
+      else if (!updateBaseline)
+	{
+	  std::cout << ", no baseline";
+	  skipped = true;
+	}
+      std::cout << std::endl;
+    }
+
+  if (updateBaseline)
+    {
+      if (!writeBaseline(baselineFile, results))
+	{
+	  std::cout << "Error writing baseline file " << baselineFile << std::endl;
+	  return 1;
+	}
+      std::cout << "Baseline written to " << baselineFile << std::endl;
+    }
+  else if (!haveBaseline)
+    std::cout << "No baseline in " << baselineFile << ", run with -u to store one" << std::endl;
+
+  if (failed)
+    {
+      std::cout << "FAILED" << std::endl;
+      return 1;
+    }
+  if (skipped)
+    {
+      std::cout << "SKIPPED, correctness passed but throughput was not compared with a baseline" << std::endl;
+      return EXIT_SKIPPED;
+    }
+  std::cout << "PASSED" << std::endl;
+  return 0;
+}
+
+//Runs the simulator for policy in lockstep with its reference model, returns false at the first divergence
+bool checkPolicy(const char* policy, const PageTrace& trace)
+{
+  PageSimulator* sim = createSimulator(policy, CHECK_PAGE_SIZE, DEFAULT_MAX_VIRTUAL_MEM, CHECK_FRAMES);
+  ReferenceModel model(policy, CHECK_FRAMES, DEFAULT_LRFU_LAMBDA, CHECK_FRAMES * DEFAULT_LFU_DECAY_FACTOR);
+  bool ok = true;
+  for (size_t i = 0; i < trace.pages.size() && ok; i++)
+    {
+      sim->accessPage(trace.pages[i], trace.writes[i] != 0);
+      int actual = sim->getLastVictim();
+      if (!model.access(trace.pages[i], trace.writes[i] != 0, actual))
+	{
+	  std::cout << policy << " on " << trace.name << ": DIVERGED at reference " << i << " (page " << trace.pages[i] << "), ";
+	  if (model.getExpectedVictim() >= 0)
+	    std::cout << "expected victim " << model.getExpectedVictim();
+	  else if (model.checksVictim() || actual < 0)
+	    std::cout << "expected no eviction";
+	  else std::cout << "expected a resident victim";
+	  std::cout << ", simulator evicted ";
+	  if (actual >= 0)
+	    std::cout << actual << std::endl;
+	  else std::cout << "nothing" << std::endl;
+	  ok = false;
+	}
+    }
+
+  const SimStats& expected = model.getStats();
+  const SimStats& actual = sim->getStats();
+  if (ok && (expected.page_faults != actual.page_faults || expected.page_replacements != actual.page_replacements
+	     || expected.flushes != actual.flushes))
+    {
+      std::cout << policy << " on " << trace.name << ": DIVERGED in totals, expected faults " << expected.page_faults
+		<< " replacements " << expected.page_replacements << " flushes " << expected.flushes << ", simulator counted "
+		<< actual.page_faults << " " << actual.page_replacements << " " << actual.flushes << std::endl;
+      ok = false;
+    }
+  if (ok)
+    std::cout << policy << " on " << trace.name << ": ok, " << trace.pages.size() << " references, " << actual.page_faults
+	      << " faults" << (model.checksVictim() ? "" : " (victims checked for residency only)") << std::endl;
+  delete sim;
+  return ok;
+}
+
+//Feeds the same records through daemons whose clocks start at 0, just short of 2^31 and just short of 2^32, and
+//	returns false unless every snapshot is the same. The logical clock only orders references, so where it starts
+//	must not change the results
+bool checkLongRun(const char* policy)
+{
+  PageTrace trace;
+  generateTrace(trace, "phases", 6, LONG_RUN_TRACE_LENGTH);
+  std::vector<uint64_t> records(trace.pages.size());
+  for (size_t i = 0; i < records.size(); i++)
+    records[i] = ((uint64_t)trace.pages[i] * CHECK_PAGE_SIZE) | (trace.writes[i] ? SIM_RECORD_WRITE_BIT : 0);
+
+  const uint64_t starts[] = { 0, (1ULL << 31) - LONG_RUN_TRACE_LENGTH / 2, (1ULL << 32) - LONG_RUN_TRACE_LENGTH / 2 };
+  const int numStarts = sizeof(starts) / sizeof(starts[0]);
+  std::vector<std::string> policies(1, policy);
+  SimSnapshotEntry entries[numStarts];
+  for (int k = 0; k < numStarts; k++)
+    {
+      SimDaemon daemon(policies, CHECK_PAGE_SIZE, DEFAULT_MAX_VIRTUAL_MEM, CHECK_FRAMES);
+      daemon.resetSimulators(starts[k]);
+      for (size_t done = 0; done < records.size(); done += LONG_RUN_BATCH)
+	daemon.simulateRecords(&records[done], records.size() - done < LONG_RUN_BATCH ? records.size() - done : LONG_RUN_BATCH);
+      std::vector<uint8_t> reply;
+      std::vector<SimStats> intervalStart;
+      daemon.makeSnapshot(reply, intervalStart);
+      memcpy(&entries[k], &reply[sizeof(SimMessageHeader) + sizeof(SimSnapshotHeader)], sizeof(SimSnapshotEntry));
+    }
+
+  for (int k = 1; k < numStarts; k++)
+    {
+      if (entries[k].page_faults != entries[0].page_faults || entries[k].page_replacements != entries[0].page_replacements
+	  || entries[k].flushes != entries[0].flushes)
+	{
+	  std::cout << policy << ": DIVERGED with the clock started at " << starts[k] << ", faults " << entries[k].page_faults
+		    << " replacements " << entries[k].page_replacements << " flushes " << entries[k].flushes << ", from 0 faults "
+		    << entries[0].page_faults << " replacements " << entries[0].page_replacements << " flushes " << entries[0].flushes << std::endl;
+	  return false;
+	}
+    }
+  std::cout << policy << ": ok, " << records.size() << " references, " << entries[0].page_faults << " faults from every start" << std::endl;
+  return true;
+}
+
+//Writes a compressed trace that mixes blocks of nearby addresses (stored packed) with blocks of scattered 64 bit
+//	addresses (stored as varints), decodes it as disjoint block ranges on several threads, and compares the
+//	result with the addresses written
+bool checkCodec()
+{
+  uint64_t state = 7;
+  std::vector<uint64_t> addrs(CODEC_TRACE_LENGTH);
+  std::vector<uint8_t> writes(CODEC_TRACE_LENGTH);
+  uint64_t addr = 0x7f0000000000ULL;
+  for (size_t i = 0; i < addrs.size(); i++)
+    {
+      uint64_t r = nextRandom(state);
+      if ((i / CODEC_BLOCK) % 3 == 2)
+	addrs[i] = r;
+      else
+	{
+	  addr += 64 + (r & 0xfff) - 0x800;
+	  addrs[i] = addr;
+	}
+      writes[i] = (r >> 32) % 3 == 0;
+    }
+
+  char fileName[] = "/tmp/policycheckXXXXXX";
+  int fd = mkstemp(fileName);
+  if (fd < 0)
+    {
+      std::cout << "Error creating a temporary trace file" << std::endl;
+      return false;
+    }
+  close(fd);
+  CompressedTraceWriter writer;
+  CompressedTraceReader reader;
+  bool ok = writer.open(fileName, CODEC_SHIFT, CODEC_BLOCK) && writer.write(&addrs[0], &writes[0], addrs.size())
+    && writer.close() && reader.open(fileName);
+  unlink(fileName);
+  if (!ok)
+    {
+      std::cout << "Error writing or reopening the compressed trace " << fileName << std::endl;
+      return false;
+    }
+
+  //each thread decodes every CODEC_THREADS-th share of the blocks as one range
+  size_t blocks = reader.getBlockCount();
+  std::vector<std::vector<uint64_t> > rangeAddrs(CODEC_THREADS);
+  std::vector<std::vector<uint8_t> > rangeWrites(CODEC_THREADS);
+  char rangeOk[CODEC_THREADS];
+  std::vector<std::thread> workers;
+  for (int t = 0; t < CODEC_THREADS; t++)
+    workers.push_back(std::thread(decodeRangeWorker, &reader, blocks * t / CODEC_THREADS, blocks * (t + 1) / CODEC_THREADS,
+				  &rangeAddrs[t], &rangeWrites[t], &rangeOk[t]));
+  for (size_t t = 0; t < workers.size(); t++)
+    workers[t].join();
+
+  size_t i = 0;
+  for (int t = 0; t < CODEC_THREADS; t++)
+    {
+      if (!rangeOk[t])
+	{
+	  std::cout << "codec: DECODE ERROR in blocks " << blocks * t / CODEC_THREADS << " to " << blocks * (t + 1) / CODEC_THREADS - 1 << std::endl;
+	  return false;
+	}
+      for (size_t k = 0; k < rangeAddrs[t].size(); k++, i++)
+	{
+	  if (i >= addrs.size() || rangeAddrs[t][k] != (addrs[i] >> CODEC_SHIFT) << CODEC_SHIFT || rangeWrites[t][k] != writes[i])
+	    {
+	      std::cout << "codec: DIVERGED at reference " << i << std::endl;
+	      return false;
+	    }
+	}
+    }
+  if (i != addrs.size())
+    {
+      std::cout << "codec: DIVERGED, decoded " << i << " of " << addrs.size() << " references" << std::endl;
+      return false;
+    }
+  std::cout << "codec: ok, " << i << " references in " << blocks << " blocks" << std::endl;
+  return true;
+}
+
+//Thread body of checkCodec, decodes blocks first to last - 1 of reader
+void decodeRangeWorker(const CompressedTraceReader* reader, size_t first, size_t last, std::vector<uint64_t>* addrs,
+		       std::vector<uint8_t>* writes, char* ok)
+{
+  *ok = reader->decodeRange(first, last, *addrs, *writes);
+}
+
+//Times the simulator for policy in PERF_CHILDREN child processes and keeps the one that ran fastest relative to
+//	the calibration loop. A policy's speed can differ by a third from one process to the next with where its
+//	heap lands, while the passes within one process agree, so one child alone is not enough
+bool measurePolicy(const char* policy, PerfResult& result)
+{
+  for (int c = 0; c < PERF_CHILDREN; c++)
+    {
+      PerfResult child;
+      if (!measureInChild(policy, child))
+	return false;
+      if (c == 0 || child.relative > result.relative)
+	result = child;
+    }
+  return true;
+}
+
+//Times the simulator for policy in a child process, alternating each pass with a pass of the calibration loop.
+//	The child inherits the parent's pages and holds the trace, so its memory is measured from the resident set
+//	it has just before the simulator is created
+bool measureInChild(const char* policy, PerfResult& result)
+{
+  int fds[2];
+  if (pipe(fds) != 0)
+    return false;
+  pid_t pid = fork();
+  if (pid < 0)
+    {
+      close(fds[0]);
+      close(fds[1]);
+      return false;
+    }
+  if (pid == 0)
+    {
+      close(fds[0]);
+      PageTrace trace;
+      generateTrace(trace, "skewed", 5, PERF_TRACE_LENGTH);
+      std::vector<uint64_t> addrs(trace.pages.size());
+      for (size_t i = 0; i < addrs.size(); i++)
+	addrs[i] = (uint64_t)trace.pages[i] * CHECK_PAGE_SIZE;
+      int maxPage = 0;
+      for (size_t i = 0; i < trace.pages.size(); i++)
+	if (trace.pages[i] > maxPage)
+	  maxPage = trace.pages[i];
+      std::vector<int> next(maxPage + 2), prev(maxPage + 2);
+
+      //writing 5 to clear_refs resets the peak (VmHWM) to the current resident set, so the peak read after the
+      //  passes is the simulator's own on top of the trace
+      std::ofstream clearRefs("/proc/self/clear_refs");
+      clearRefs << "5" << std::flush;
+      clearRefs.close();
+      long startRss = statusKb("VmRSS:");
+
+      //the best of several passes, since the machine's speed drifts with whatever else is running on it
+      PageSimulator* sim = createSimulator(policy, CHECK_PAGE_SIZE, DEFAULT_MAX_VIRTUAL_MEM, PERF_FRAMES);
+      PerfResult child;
+      child.refs_per_second = 0;
+      double calibrationRate = 0;
+      for (int r = 0; r < PERF_REPEATS; r++)
+	{
+	  double start = cpuSeconds();
+	  calibrationPass(trace.pages, next, prev);
+	  double elapsed = cpuSeconds() - start;
+	  if (elapsed > 0 && trace.pages.size() / elapsed > calibrationRate)
+	    calibrationRate = trace.pages.size() / elapsed;
+
+	  sim->reset();
+	  start = cpuSeconds();
+	  sim->access(&addrs[0], &trace.writes[0], addrs.size());
+	  elapsed = cpuSeconds() - start;
+	  if (elapsed > 0 && addrs.size() / elapsed > child.refs_per_second)
+	    child.refs_per_second = addrs.size() / elapsed;
+	}
+      child.relative = calibrationRate > 0 ? child.refs_per_second / calibrationRate : 0;
+      long peak = statusKb("VmHWM:");
+      child.memory_kb = peak >= 0 && startRss >= 0 ? peak - startRss : -1;
+      delete sim;
+      ssize_t written = write(fds[1], &child, sizeof(child));
+      _exit(written == (ssize_t)sizeof(child) ? 0 : 1);
+    }
+
+  close(fds[1]);
+  ssize_t got = read(fds[0], &result, sizeof(result));
+  close(fds[0]);
+  int status;
+  waitpid(pid, &status, 0);
+  return got == (ssize_t)sizeof(result) && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+//The fixed work each policy's throughput is divided by, so the baseline holds up on faster and slower machines
+//	and builds. It keeps the PERF_FRAMES most recently referenced pages in a move-to-front list held in the
+//	arrays next and prev (one entry per page plus the list head), the same kind of table and pointer work the
+//	simulators do. It is written here rather than in the library so that library changes never change it
+void calibrationPass(const std::vector<int>& pages, std::vector<int>& next, std::vector<int>& prev)
+{
+  int head = (int)next.size() - 1;
+  std::fill(prev.begin(), prev.end(), -1);
+  next[head] = head;
+  prev[head] = head;
+  int size = 0;
+  for (size_t i = 0; i < pages.size(); i++)
+    {
+      int p = pages[i];
+      if (prev[p] >= 0) //in the list, unlink it to move it to the front
+	{
+	  next[prev[p]] = next[p];
+	  prev[next[p]] = prev[p];
+	}
+      else
+	{
+	  if (size == PERF_FRAMES) //drop the least recent page
+	    {
+	      int tail = prev[head];
+	      next[prev[tail]] = head;
+	      prev[head] = prev[tail];
+	      prev[tail] = -1;
+	    }
+	  else size++;
+	}
+      next[p] = next[head];
+      prev[p] = head;
+      prev[next[head]] = p;
+      next[head] = p;
+    }
+}
+
+//Returns the value in KB of a field of /proc/self/status such as "VmRSS:", -1 if it cannot be read
+long statusKb(const char* field)
+{
+  std::ifstream fin("/proc/self/status");
+  std::string name;
+  long kb;
+  while (fin >> name)
+    {
+      if (name == field)
+	return fin >> kb ? kb : -1;
+      std::getline(fin, name);
+    }
+  return -1;
+}
+
+//Returns the CPU time used by this process, so other processes on the machine do not count against a policy
+double cpuSeconds()
+{
+  timespec now;
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &now);
+  return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+//xorshift64*, the generated traces must not depend on the C library's rand()
+uint64_t nextRandom(uint64_t& state)
+{
+  state ^= state >> 12;
+  state ^= state << 25;
+  state ^= state >> 27;
+  return state * 2685821657736338717ULL;
+}
+
+//Generates a trace of the given kind, about a third of the references are writes
+//	uniform - every reference picks one of 4 * CHECK_FRAMES pages at random
+//	loop - sweeps over 1.5 * CHECK_FRAMES pages in order, the case LRU and FIFO handle worst
+//	skewed - most references go to a few hot pages out of 4096, favouring the frequency based algorithms
+//	phases - a working set a little larger than memory that moves every 20000 references
+void generateTrace(PageTrace& trace, const std::string& kind, uint64_t seed, int length)
+{
+  uint64_t state = seed * 0x9E3779B97F4A7C15ULL + 1;
+  trace.name = kind;
+  trace.pages.resize(length);
+  trace.writes.resize(length);
+  for (int i = 0; i < length; i++)
+    {
+      uint64_t r = nextRandom(state);
+      double u = (r >> 11) * (1.0 / 9007199254740992.0); //uniform in [0, 1)
+      int page;
+      if (kind == "uniform")
+	page = (int)(u * 4 * CHECK_FRAMES);
+      else if (kind == "loop")
+	page = i % (CHECK_FRAMES + CHECK_FRAMES / 2);
+      else if (kind == "skewed")
+	page = (int)(4096 * u * u * u * u);
+      else
+	page = (i / 20000) * 37 + (int)(u * (CHECK_FRAMES + CHECK_FRAMES / 4));
+      trace.pages[i] = page;
+      trace.writes[i] = (nextRandom(state) % 3) == 0;
+    }
+}
+
+//Reads a recorded trace, dropping references outside of virtual memory. Returns false if the file cannot be
+//  read, or if it is a compressed trace that is damaged
+bool loadTrace(PageTrace& trace, const char* fileName, int maxVirtualMem)
+{
+  trace.name = fileName;
+  PageNumberMap pageMap(CHECK_PAGE_SIZE, maxVirtualMem);
+
+  CompressedTraceReader compressed;
+  if (CompressedTraceReader::isCompressedTrace(fileName))
+    {
+      if (!compressed.open(fileName))
+	return false;
+      std::vector<uint64_t> addrs;
+      std::vector<uint8_t> isWrite;
+      bool readOk;
+      while ((readOk = compressed.readBlock(addrs, isWrite)) && !addrs.empty())
+	{
+	  for (size_t i = 0; i < addrs.size(); i++)
+	    {
+	      int page = pageMap.pageOf(addrs[i]);
+	      if (page >= 0)
+		{
+		  trace.pages.push_back(page);
+		  trace.writes.push_back(isWrite[i]);
+		}
+	    }
+	}
+      return readOk;
+    }
+
+  std::ifstream fin(fileName);
+  if (!fin)
+    return false;
+  long long nextReference;
+  while (fin >> nextReference)
+    {
+      int page = nextReference >= 0 ? pageMap.pageOf((uint64_t)nextReference) : -1;
+      if (page >= 0)
+	{
+	  trace.pages.push_back(page);
+	  trace.writes.push_back(nextReference % 2 != 0); //odd addresses are write references
+	}
+    }
+  return true;
+}
+
+//Reads "policy relative-throughput" lines, returns false if the file cannot be opened
+bool readBaseline(const char* fileName, std::map<std::string, double>& baseline)
+{
+  std::ifstream fin(fileName);
+  if (!fin)
+    return false;
+  std::string line;
+  while (std::getline(fin, line))
+    {
+      if (line.empty() || line[0] == '#')
+	continue;
+      size_t space = line.find(' ');
+      if (space != std::string::npos)
+	baseline[line.substr(0, space)] = atof(line.c_str() + space + 1);
+    }
+  return true;
+}
+
+bool writeBaseline(const char* fileName, const std::map<std::string, PerfResult>& results)
+{
+  std::ofstream fout(fileName);
+  if (!fout)
+    return false;
+  fout << "# policycheck baseline: references per second on " << PERF_TRACE_LENGTH << " references, " << PERF_FRAMES
+       << " frames," << std::endl << "# divided by the calibration loop's references per second in the same run" << std::endl;
+  fout << "# refresh with ./policycheck -u after a deliberate performance change, and commit this file" << std::endl;
+  for (std::map<std::string, PerfResult>::const_iterator it = results.begin(); it != results.end(); ++it)
+    fout << it->first << " " << std::fixed << std::setprecision(4) << it->second.relative << std::endl;
+  return fout.good();
+}